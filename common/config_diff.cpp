@@ -0,0 +1,251 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "config_diff.h"
+
+#include <algorithm>
+
+namespace ConfigDiff
+{
+
+OutputState::OutputState(const Disman::OutputPtr& output)
+    : enabled(output->enabled())
+    , mode(output->auto_mode())
+    , position(output->position())
+    , scale(output->scale())
+    , rotation(output->rotation())
+    , adaptiveSync(output->adaptive_sync())
+    , replicationSource(output->replication_source())
+    , retention(output->retention())
+    , autoResolution(output->auto_resolution())
+    , autoRefreshRate(output->auto_refresh_rate())
+    , autoRotate(output->auto_rotate())
+    , autoRotateOnlyInTabletMode(output->auto_rotate_only_in_tablet_mode())
+{
+}
+
+void OutputState::apply(const Disman::OutputPtr& output, Fields fields) const
+{
+    if (fields & Field::Enabled) {
+        output->set_enabled(enabled);
+    }
+    if (fields & Field::AutoResolution) {
+        output->set_auto_resolution(autoResolution);
+    }
+    if (fields & Field::AutoRefreshRate) {
+        output->set_auto_refresh_rate(autoRefreshRate);
+    }
+    if (fields & Field::Mode && mode) {
+        output->set_resolution(mode->size());
+        output->set_refresh_rate(mode->refresh());
+    }
+    if (fields & Field::Position) {
+        output->set_position(position);
+    }
+    if (fields & Field::Scale) {
+        output->set_scale(scale);
+    }
+    if (fields & Field::Rotation) {
+        output->set_rotation(rotation);
+    }
+    if (fields & Field::AdaptiveSync) {
+        output->set_adaptive_sync(adaptiveSync);
+    }
+    if (fields & Field::ReplicationSource) {
+        output->set_replication_source(replicationSource);
+    }
+    if (fields & Field::Retention) {
+        output->set_retention(retention);
+    }
+    if (fields & Field::AutoRotate) {
+        output->set_auto_rotate(autoRotate);
+    }
+    if (fields & Field::AutoRotateOnlyInTabletMode) {
+        output->set_auto_rotate_only_in_tablet_mode(autoRotateOnlyInTabletMode);
+    }
+}
+
+static bool sameMode(const Disman::ModePtr& mode1, const Disman::ModePtr& mode2)
+{
+    if (!mode1 || !mode2) {
+        return mode1 == mode2;
+    }
+    return mode1->size() == mode2->size() && mode1->refresh() == mode2->refresh();
+}
+
+bool OutputState::operator==(const OutputState& other) const
+{
+    return enabled == other.enabled && sameMode(mode, other.mode) && position == other.position
+        && scale == other.scale && rotation == other.rotation && adaptiveSync == other.adaptiveSync
+        && replicationSource == other.replicationSource && retention == other.retention
+        && autoResolution == other.autoResolution && autoRefreshRate == other.autoRefreshRate
+        && autoRotate == other.autoRotate
+        && autoRotateOnlyInTabletMode == other.autoRotateOnlyInTabletMode;
+}
+
+bool OutputState::operator!=(const OutputState& other) const
+{
+    return !(*this == other);
+}
+
+static bool differs(Field field, const OutputState& state, const OutputState& base)
+{
+    switch (field) {
+    case Field::Enabled:
+        return state.enabled != base.enabled;
+    case Field::Mode:
+        return !sameMode(state.mode, base.mode);
+    case Field::Position:
+        return state.position != base.position;
+    case Field::Scale:
+        return state.scale != base.scale;
+    case Field::Rotation:
+        return state.rotation != base.rotation;
+    case Field::AdaptiveSync:
+        return state.adaptiveSync != base.adaptiveSync;
+    case Field::ReplicationSource:
+        return state.replicationSource != base.replicationSource;
+    case Field::Retention:
+        return state.retention != base.retention;
+    case Field::AutoResolution:
+        return state.autoResolution != base.autoResolution;
+    case Field::AutoRefreshRate:
+        return state.autoRefreshRate != base.autoRefreshRate;
+    case Field::AutoRotate:
+        return state.autoRotate != base.autoRotate;
+    case Field::AutoRotateOnlyInTabletMode:
+        return state.autoRotateOnlyInTabletMode != base.autoRotateOnlyInTabletMode;
+    }
+    return false;
+}
+
+Fields compare(const OutputState& state, const OutputState& base, Fields fields)
+{
+    Fields differences;
+    for (int bit = 0; bit < FieldCount; bit++) {
+        auto const field = static_cast<Field>(1 << bit);
+        if (!(fields & field)) {
+            continue;
+        }
+        if (field != Field::Enabled && !state.enabled) {
+            continue;
+        }
+        if (differs(field, state, base)) {
+            differences |= field;
+        }
+    }
+    return differences;
+}
+
+bool Delta::isEmpty() const
+{
+    return outputs.isEmpty() && removedOutputs == 0 && !primary;
+}
+
+Snapshot::Snapshot(const Disman::ConfigPtr& config)
+{
+    for (auto const& [key, output] : config->outputs()) {
+        auto const hash = output->hash();
+        if (!outputs.contains(hash)) {
+            outputs.insert(hash, std::make_shared<const OutputState>(output));
+        }
+    }
+    if (auto const primaryOutput = config->primary_output()) {
+        primary = primaryOutput->hash();
+    }
+}
+
+bool primaryDiffers(const Disman::ConfigPtr& config, const Snapshot& base)
+{
+    if (!(config->supported_features() & Disman::Config::Feature::PrimaryDisplay)) {
+        return false;
+    }
+    auto const primaryOutput = config->primary_output();
+    return (primaryOutput ? primaryOutput->hash() : QString()) != base.primary;
+}
+
+bool primaryDiffers(const Disman::ConfigPtr& config, const Disman::ConfigPtr& base)
+{
+    if (!(config->supported_features() & Disman::Config::Feature::PrimaryDisplay)) {
+        return false;
+    }
+    if (config->primary_output() && base->primary_output()) {
+        return config->primary_output()->hash() != base->primary_output()->hash();
+    }
+    return (bool)config->primary_output() != (bool)base->primary_output();
+}
+
+Delta compute(const Disman::ConfigPtr& config, const Snapshot& base)
+{
+    auto const& baseOutputs = base.outputs;
+
+    Delta delta;
+    delta.primary = primaryDiffers(config, base);
+
+    int matched = 0;
+    for (auto const& [key, output] : config->outputs()) {
+        auto const baseOutput = baseOutputs.constFind(output->hash());
+        if (baseOutput == baseOutputs.cend()) {
+            delta.outputs.insert(output->id(), AllFields);
+            continue;
+        }
+        matched++;
+        if (auto const fields = compare(OutputState(output), **baseOutput, AllFields)) {
+            delta.outputs.insert(output->id(), fields);
+        }
+    }
+    delta.removedOutputs = std::max(0, static_cast<int>(baseOutputs.size()) - matched);
+
+    return delta;
+}
+
+Delta compute(const Disman::ConfigPtr& config, const Disman::ConfigPtr& base)
+{
+    return compute(config, Snapshot(base));
+}
+
+}
+
+QDebug operator<<(QDebug dbg, const ConfigDiff::Delta& delta)
+{
+    using Field = ConfigDiff::Field;
+
+    // In the order of the field bits.
+    static const char* const names[ConfigDiff::FieldCount] = {
+        "enabled",
+        "mode",
+        "position",
+        "scale",
+        "rotation",
+        "adaptive sync",
+        "replication source",
+        "retention",
+        "auto resolution",
+        "auto refresh rate",
+        "auto rotate",
+        "auto rotate only in tablet mode",
+    };
+
+    QDebugStateSaver saver(dbg);
+    dbg.nospace() << "ConfigDiff::Delta(";
+    if (delta.primary) {
+        dbg << "primary ";
+    }
+    for (auto it = delta.outputs.cbegin(); it != delta.outputs.cend(); it++) {
+        dbg << "output " << it.key() << ":";
+        for (int bit = 0; bit < ConfigDiff::FieldCount; bit++) {
+            auto const field = static_cast<Field>(1 << bit);
+            if (it.value() & field) {
+                dbg << " " << names[bit];
+            }
+        }
+        dbg << "; ";
+    }
+    if (delta.removedOutputs) {
+        dbg << delta.removedOutputs << " removed";
+    }
+    dbg << ")";
+    return dbg;
+}
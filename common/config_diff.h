@@ -0,0 +1,122 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <disman/config.h>
+#include <disman/output.h>
+
+#include <QDebug>
+#include <QFlags>
+#include <QHash>
+
+#include <memory>
+
+/**
+ * Compares configs field by field to find out what would change when applying one of them.
+ */
+namespace ConfigDiff
+{
+
+/**
+ * Output properties that are compared.
+ */
+enum class Field {
+    Enabled = 1 << 0,
+    Mode = 1 << 1,
+    Position = 1 << 2,
+    Scale = 1 << 3,
+    Rotation = 1 << 4,
+    AdaptiveSync = 1 << 5,
+    ReplicationSource = 1 << 6,
+    Retention = 1 << 7,
+    AutoResolution = 1 << 8,
+    AutoRefreshRate = 1 << 9,
+    AutoRotate = 1 << 10,
+    AutoRotateOnlyInTabletMode = 1 << 11,
+};
+Q_DECLARE_FLAGS(Fields, Field)
+
+constexpr int FieldCount = 12;
+constexpr Fields AllFields = Fields::fromInt((1 << FieldCount) - 1);
+
+/**
+ * Immutable copy of the compared properties of an output. States can be shared between snapshots
+ * of a config. The mode is shared with the output. Its list of modes is replaced when the backend
+ * reports a new one, and the ids might then name other modes. Modes are therefore compared by
+ * resolution and refresh rate like they are applied.
+ */
+struct OutputState {
+    explicit OutputState(const Disman::OutputPtr& output);
+
+    /**
+     * Sets the properties in @p fields on @p output.
+     */
+    void apply(const Disman::OutputPtr& output, Fields fields = AllFields) const;
+
+    bool operator==(const OutputState& other) const;
+    bool operator!=(const OutputState& other) const;
+
+    bool enabled;
+    Disman::ModePtr mode;
+    QPointF position;
+    double scale;
+    Disman::Output::Rotation rotation;
+    bool adaptiveSync;
+    int replicationSource;
+    Disman::Output::Retention retention;
+    bool autoResolution;
+    bool autoRefreshRate;
+    bool autoRotate;
+    bool autoRotateOnlyInTabletMode;
+};
+
+/**
+ * @return the subset of @p fields in which @p state differs from @p base. Only whether it is
+ * enabled matters for a disabled output.
+ */
+Fields compare(const OutputState& state, const OutputState& base, Fields fields);
+
+/**
+ * Changes of a config in relation to a base config. Outputs are matched by their hashes.
+ */
+struct Delta {
+    bool isEmpty() const;
+
+    /** Changed fields by output id. Outputs that are not in the base have all fields set. */
+    QHash<int, Fields> outputs;
+    /** Number of outputs in the base that are missing. */
+    int removedOutputs = 0;
+    bool primary = false;
+};
+
+/**
+ * Compared state of a config. Unlike a clone of the config it does not copy any modes, and
+ * snapshots can share the states of outputs that did not change in between.
+ */
+struct Snapshot {
+    Snapshot() = default;
+    explicit Snapshot(const Disman::ConfigPtr& config);
+
+    /** Output states by output hash. For outputs with the same hash the first one is kept. */
+    QHash<QString, std::shared_ptr<const OutputState>> outputs;
+    /** Hash of the primary output or empty if there is none. */
+    QString primary;
+};
+
+Delta compute(const Disman::ConfigPtr& config, const Snapshot& base);
+Delta compute(const Disman::ConfigPtr& config, const Disman::ConfigPtr& base);
+
+/**
+ * @return whether the primary outputs of @p config and @p base differ, if the backend supports
+ * primary outputs at all.
+ */
+bool primaryDiffers(const Disman::ConfigPtr& config, const Snapshot& base);
+bool primaryDiffers(const Disman::ConfigPtr& config, const Disman::ConfigPtr& base);
+}
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ConfigDiff::Fields)
+
+QDebug operator<<(QDebug dbg, const ConfigDiff::Delta& delta);
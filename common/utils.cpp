@@ -21,6 +21,7 @@
 
 #include "utils.h"
 
+#include <disman/config.h>
 #include <disman/output.h>
 
 #include <KLocalizedString>
@@ -42,3 +43,13 @@ QString Utils::sizeToString(const QSize& size)
 {
     return QStringLiteral("%1x%2").arg(size.width()).arg(size.height());
 }
+
+QStringList Utils::outputHashes(const Disman::ConfigPtr& config)
+{
+    QStringList hashes;
+    for (auto const& [key, output] : config->outputs()) {
+        hashes.append(QString::fromStdString(output->hash()));
+    }
+    hashes.sort();
+    return hashes;
+}
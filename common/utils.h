@@ -24,6 +24,7 @@
 
 #include <QSize>
 #include <QString>
+#include <QStringList>
 
 #include <disman/output.h>
 #include <disman/types.h>
@@ -34,6 +35,12 @@ QString outputName(const Disman::Output* output);
 QString outputName(const Disman::OutputPtr& output);
 
 QString sizeToString(const QSize& size);
+
+/**
+ * @return sorted hashes of all outputs in @p config. Processes compare these to tell whether
+ * they see the same outputs connected.
+ */
+QStringList outputHashes(const Disman::ConfigPtr& config);
 }
 
 #endif
@@ -0,0 +1,165 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "x_resources.h"
+
+#include <QList>
+#include <QVector>
+
+#include <xcb/xcb.h>
+#include <xcb/xproto.h>
+
+#include <cstdlib>
+#include <memory>
+
+namespace XResources
+{
+
+namespace
+{
+
+struct Connection {
+    explicit Connection(const QByteArray& displayName)
+        : connection(xcb_connect(displayName.isEmpty() ? nullptr : displayName.constData(),
+                                 nullptr))
+    {
+        if (!xcb_connection_has_error(connection)) {
+            // The database is a property of the first screen's root window, independent of the
+            // screen in the display name.
+            root = xcb_setup_roots_iterator(xcb_get_setup(connection)).data->root;
+        }
+    }
+    ~Connection()
+    {
+        xcb_disconnect(connection);
+    }
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    bool isValid() const
+    {
+        return root != XCB_WINDOW_NONE;
+    }
+
+    QByteArray database() const
+    {
+        auto const cookie = xcb_get_property(connection,
+                                             false,
+                                             root,
+                                             XCB_ATOM_RESOURCE_MANAGER,
+                                             XCB_ATOM_STRING,
+                                             0,
+                                             UINT32_MAX / 4);
+        std::unique_ptr<xcb_get_property_reply_t, decltype(&free)> reply(
+            xcb_get_property_reply(connection, cookie, nullptr), &free);
+        if (!reply || reply->format != 8) {
+            return QByteArray();
+        }
+        return QByteArray(static_cast<const char*>(xcb_get_property_value(reply.get())),
+                          xcb_get_property_value_length(reply.get()));
+    }
+
+    xcb_connection_t* connection;
+    xcb_window_t root = XCB_WINDOW_NONE;
+};
+
+}
+
+bool writeXftDpi(int dpi, const QByteArray& displayName)
+{
+    Connection const xcb(displayName);
+    if (!xcb.isValid()) {
+        return false;
+    }
+
+    // Other clients might update the database in between reading and writing it.
+    xcb_grab_server(xcb.connection);
+
+    auto const database = xcb.database();
+    auto const value = dpi > 0 ? QByteArray::number(dpi) : QByteArray();
+    auto const updated = setResource(database, QByteArrayLiteral("Xft.dpi"), value);
+
+    bool success = true;
+    if (updated != database) {
+        auto const cookie = xcb_change_property_checked(xcb.connection,
+                                                        XCB_PROP_MODE_REPLACE,
+                                                        xcb.root,
+                                                        XCB_ATOM_RESOURCE_MANAGER,
+                                                        XCB_ATOM_STRING,
+                                                        8,
+                                                        updated.size(),
+                                                        updated.constData());
+        if (auto const error = xcb_request_check(xcb.connection, cookie)) {
+            free(error);
+            success = false;
+        }
+    }
+
+    xcb_ungrab_server(xcb.connection);
+    xcb_flush(xcb.connection);
+    return success;
+}
+
+QByteArray database(const QByteArray& displayName)
+{
+    Connection const xcb(displayName);
+    if (!xcb.isValid()) {
+        return QByteArray();
+    }
+    return xcb.database();
+}
+
+QByteArray setResource(const QByteArray& database, const QByteArray& name, const QByteArray& value)
+{
+    auto const lines = database.split('\n');
+
+    QVector<int> entries;
+    for (int i = 0; i < lines.size(); i++) {
+        auto const& line = lines.at(i);
+        auto const colon = line.indexOf(':');
+        if (colon >= 0 && line.left(colon).trimmed() == name) {
+            entries.append(i);
+        }
+    }
+
+    if (entries.isEmpty() && value.isEmpty()) {
+        return database;
+    }
+    if (entries.size() == 1 && !value.isEmpty()) {
+        auto const& line = lines.at(entries.first());
+        if (line.mid(line.indexOf(':') + 1).trimmed() == value) {
+            return database;
+        }
+    }
+
+    // All other lines are kept byte for byte.
+    QByteArray result;
+    result.reserve(database.size() + name.size() + value.size() + 3);
+
+    for (int i = 0; i < lines.size(); i++) {
+        auto const last = i == lines.size() - 1;
+        if (entries.contains(i)) {
+            if (i != entries.first() || value.isEmpty()) {
+                continue;
+            }
+            result += name + ":\t" + value;
+        } else {
+            result += lines.at(i);
+        }
+        if (!last) {
+            result += '\n';
+        }
+    }
+
+    if (entries.isEmpty()) {
+        if (!result.isEmpty() && !result.endsWith('\n')) {
+            result += '\n';
+        }
+        result += name + ":\t" + value + '\n';
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,40 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QByteArray>
+
+/**
+ * Access to the resource database of an X server, which is stored in the RESOURCE_MANAGER
+ * property of the first root window. Talks to the server directly instead of through xrdb, and
+ * can be called from any thread as every call uses its own connection.
+ */
+namespace XResources
+{
+
+/**
+ * Sets the Xft.dpi resource, or removes it when @p dpi is 0. All other resources are kept.
+ *
+ * @param displayName the X display to connect to, by default the one from the environment.
+ * @return true if the database was updated or already up to date, false if there is no X server.
+ */
+bool writeXftDpi(int dpi, const QByteArray& displayName = QByteArray());
+
+/**
+ * @return the resource database or an empty array if there is none or no X server.
+ */
+QByteArray database(const QByteArray& displayName = QByteArray());
+
+/**
+ * Sets the resource @p name in @p database to @p value, replacing the first entry for it and
+ * dropping further ones. An empty value removes the resource. All other lines are kept as they
+ * are, and a database already holding the value is returned unchanged.
+ *
+ * @return the updated database.
+ */
+QByteArray setResource(const QByteArray& database, const QByteArray& name, const QByteArray& value);
+
+}
@@ -22,10 +22,30 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <disman/configmonitor.h>
 #include <disman/getconfigoperation.h>
 
-#include <QRect>
+#include <algorithm>
 
 using namespace Disman;
 
+/**
+ * @return whether @p output and @p other offer different modes.
+ */
+static bool modesDiffer(const Disman::OutputPtr& output, const Disman::OutputPtr& other)
+{
+    auto const modes = output->modes();
+    auto const otherModes = other->modes();
+    if (modes.size() != otherModes.size()) {
+        return true;
+    }
+    for (auto const& [key, mode] : modes) {
+        auto const otherMode = otherModes.find(key);
+        if (otherMode == otherModes.end() || mode->size() != otherMode->second->size()
+            || mode->refresh() != otherMode->second->refresh()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 ConfigHandler::ConfigHandler(QObject* parent)
     : QObject(parent)
 {
@@ -34,29 +54,46 @@ ConfigHandler::ConfigHandler(QObject* parent)
 void ConfigHandler::setConfig(Disman::ConfigPtr config)
 {
     m_config = config;
-    m_initialConfig = m_config->clone();
-    Disman::ConfigMonitor::instance()->add_config(m_config);
+    m_history.reset(m_config);
+    setInitial(snapshot());
+
+    // The monitor overwrites the configs it updates, so it gets a copy to merge from.
+    m_backendConfig = m_config->clone();
+    Disman::ConfigMonitor::instance()->add_config(m_backendConfig);
+    connect(Disman::ConfigMonitor::instance(),
+            &Disman::ConfigMonitor::configuration_changed,
+            this,
+            &ConfigHandler::mergeBackendChanges);
 
     m_outputs = new OutputModel(this);
-    connect(
-        m_outputs, &OutputModel::positionChanged, this, &ConfigHandler::checkScreenNormalization);
-    connect(m_outputs, &OutputModel::sizeChanged, this, &ConfigHandler::checkScreenNormalization);
+    auto const normalizationChanged = [this] {
+        m_stale.normalization = true;
+        scheduleRevalidation();
+    };
+    connect(m_outputs, &OutputModel::positionChanged, this, normalizationChanged);
+    connect(m_outputs, &OutputModel::sizeChanged, this, normalizationChanged);
 
     for (auto const& [key, output] : config->outputs()) {
         initOutput(output);
     }
     m_lastNormalizedScreenSize = screenSize();
+    m_lastRetention = retention();
 
     connect(m_outputs, &OutputModel::changed, this, [this]() {
-        checkNeedsSave();
-        Q_EMIT changed();
-    });
-    connect(m_config.get(), &Disman::Config::output_added, this, [this]() {
-        Q_EMIT outputConnect(true);
-    });
-    connect(m_config.get(), &Disman::Config::output_removed, this, [this]() {
-        Q_EMIT outputConnect(false);
+        recordHistory();
+        m_stale.needsSave = true;
+        m_stale.retention = true;
+        m_stale.changed = true;
+        scheduleRevalidation();
     });
+    connect(m_backendConfig.get(),
+            &Disman::Config::output_added,
+            this,
+            &ConfigHandler::backendOutputAdded);
+    connect(m_backendConfig.get(),
+            &Disman::Config::output_removed,
+            this,
+            &ConfigHandler::backendOutputRemoved);
     connect(m_config.get(),
             &Disman::Config::primary_output_changed,
             this,
@@ -77,84 +114,367 @@ void ConfigHandler::updateInitialData()
             if (op->has_error()) {
                 return;
             }
-            m_initialConfig = qobject_cast<GetConfigOperation*>(op)->config();
+            setInitial(ConfigDiff::Snapshot(qobject_cast<GetConfigOperation*>(op)->config()));
+            for (auto const& [key, output] : m_config->outputs()) {
+                updateDifferences(output, AllFields);
+            }
             checkNeedsSave();
         });
 }
 
-void ConfigHandler::checkNeedsSave()
+ConfigDiff::Snapshot ConfigHandler::beginApply()
 {
-    if (m_config->supported_features() & Disman::Config::Feature::PrimaryDisplay) {
-        if (m_config->primary_output() && m_initialConfig->primary_output()) {
-            if (m_config->primary_output()->hash() != m_initialConfig->primary_output()->hash()) {
-                Q_EMIT needsSaveChecked(true);
-                return;
-            }
-        } else if ((bool)m_config->primary_output() != (bool)m_initialConfig->primary_output()) {
-            Q_EMIT needsSaveChecked(true);
-            return;
-        }
+    recordHistory();
+    return snapshot();
+}
+
+void ConfigHandler::adoptAppliedConfig(ConfigDiff::Snapshot applied)
+{
+    setInitial(std::move(applied));
+    for (auto const& [key, output] : m_config->outputs()) {
+        updateDifferences(output, AllFields);
+    }
+    m_editedOutputs.clear();
+
+    checkNeedsSave();
+    m_confirmingApplied = true;
+}
+
+void ConfigHandler::cancelAppliedConfirmation()
+{
+    m_confirmingApplied = false;
+}
+
+void ConfigHandler::setInitial(ConfigDiff::Snapshot initial)
+{
+    m_initial = std::move(initial);
+    m_initialOutputs.clear();
+    m_differences.clear();
+}
+
+void ConfigHandler::backendOutputAdded(const Disman::OutputPtr& output)
+{
+    if (m_config->outputs().count(output->id())) {
+        return;
+    }
+    m_historyBlocked = true;
+
+    // The backend state is the base for the new output, so it starts without differences.
+    auto const hash = output->hash();
+    if (!m_initial.outputs.contains(hash)) {
+        m_initial.outputs.insert(hash, std::make_shared<const ConfigDiff::OutputState>(output));
+    }
+    m_initialOutputs.remove(output->id());
+
+    auto const added = output->clone();
+    m_config->add_output(added);
+    m_outputs->add(added);
+    m_history.update(m_config, {added->id()});
+
+    m_editedOutputs.clear();
+    m_historyBlocked = false;
+
+    m_stale.needsSave = true;
+    m_stale.retention = true;
+    m_stale.changed = true;
+    scheduleRevalidation();
+    Q_EMIT outputConnect(true);
+}
+
+void ConfigHandler::backendOutputRemoved(int outputId)
+{
+    auto const outputs = m_config->outputs();
+    auto const output = outputs.find(outputId);
+    if (output == outputs.end()) {
+        return;
+    }
+
+    // Outputs with the same hash, like two monitors of the same model, share the initial state.
+    // It is only dropped with the last of them.
+    auto const hash = output->second->hash();
+    auto const shared = std::any_of(outputs.cbegin(), outputs.cend(), [&](auto const& other) {
+        return other.first != outputId && other.second->hash() == hash;
+    });
+    if (!shared) {
+        m_initial.outputs.remove(hash);
     }
 
+    m_outputs->remove(outputId);
+    m_config->remove_output(outputId);
+
+    m_stale.needsSave = true;
+    m_stale.retention = true;
+    m_stale.changed = true;
+    scheduleRevalidation();
+    Q_EMIT outputConnect(false);
+}
+
+ConfigDiff::Snapshot ConfigHandler::snapshot() const
+{
+    ConfigDiff::Snapshot snapshot;
     for (auto const& [key, output] : m_config->outputs()) {
         auto const hash = output->hash();
-        for (auto const& [initial_key, initialOutput] : m_initialConfig->outputs()) {
-            if (hash != initialOutput->hash()) {
-                continue;
-            }
-            bool needsSave = false;
-            if (output->enabled() != initialOutput->enabled()) {
-                needsSave = true;
-            }
-            if (output->enabled()) {
-                needsSave |= output->auto_mode()->id() != initialOutput->auto_mode()->id()
-                    || output->position() != initialOutput->position()
-                    || output->scale() != initialOutput->scale()
-                    || output->rotation() != initialOutput->rotation()
-                    || output->adaptive_sync() != initialOutput->adaptive_sync()
-                    || output->replication_source() != initialOutput->replication_source()
-                    || output->retention() != initialOutput->retention()
-                    || output->auto_resolution() != initialOutput->auto_resolution()
-                    || output->auto_refresh_rate() != initialOutput->auto_refresh_rate()
-                    || output->auto_rotate() != initialOutput->auto_rotate()
-                    || output->auto_rotate_only_in_tablet_mode()
-                        != initialOutput->auto_rotate_only_in_tablet_mode();
-            }
-            if (needsSave) {
-                Q_EMIT needsSaveChecked(true);
-                return;
-            }
-            break;
+        if (snapshot.outputs.contains(hash)) {
+            continue;
         }
+        if (auto state = m_history.output(output->id())) {
+            snapshot.outputs.insert(hash, std::move(state));
+        }
+    }
+    if (auto const primary = m_config->primary_output()) {
+        snapshot.primary = primary->hash();
     }
-    Q_EMIT needsSaveChecked(false);
+    return snapshot;
 }
 
-QSize ConfigHandler::screenSize() const
+Disman::ConfigPtr ConfigHandler::initialConfig() const
+{
+    if (!m_config) {
+        return nullptr;
+    }
+
+    auto config = m_config->clone();
+    for (auto const& [key, output] : config->outputs()) {
+        if (auto const state = m_initial.outputs.value(output->hash())) {
+            state->apply(output);
+        }
+    }
+    return config;
+}
+
+void ConfigHandler::mergeBackendChanges()
 {
-    int width = 0, height = 0;
-    QSize size;
+    // Three-way merge with the initial state as base. Fields that the backend changed and the
+    // user did not are taken over in place. Fields the user changed stay as they are.
+    m_historyBlocked = true;
 
-    for (auto const& [key, output] : m_config->outputs()) {
-        if (!output->positionable()) {
+    auto const outputs = m_config->outputs();
+    QVector<int> mergedIds;
+
+    for (auto const& [key, incoming] : m_backendConfig->outputs()) {
+        auto const output = outputs.find(incoming->id());
+        if (output == outputs.end()) {
             continue;
         }
-        const int outputRight = output->geometry().right();
-        const int outputBottom = output->geometry().bottom();
 
-        if (outputRight > width) {
-            width = outputRight;
+        // Modes are not edited by the user, the backend's list is always taken over. The
+        // output is not updated by the monitor, so the model must be told about it.
+        auto const modesChanged = modesDiffer(output->second, incoming);
+        if (modesChanged) {
+            Disman::ModeMap modes;
+            for (auto const& [modeKey, mode] : incoming->modes()) {
+                modes.insert({modeKey, mode->clone()});
+            }
+            output->second->set_modes(modes);
         }
-        if (outputBottom > height) {
-            height = outputBottom;
+
+        ConfigDiff::OutputState const state(incoming);
+        auto const base = initialOutput(output->second);
+        auto const external = base ? ConfigDiff::compare(state, *base, AllFields) : AllFields;
+        auto const merge = external & ~m_differences.value(incoming->id());
+        if (merge) {
+            state.apply(output->second, merge);
         }
+        if (merge || modesChanged) {
+            mergedIds.append(incoming->id());
+        }
+    }
+
+    if (!ConfigDiff::primaryDiffers(m_config, m_initial)
+        && ConfigDiff::primaryDiffers(m_backendConfig, m_initial)) {
+        auto const incoming = m_backendConfig->primary_output();
+        auto const primary = incoming ? outputs.find(incoming->id()) : outputs.end();
+        m_config->set_primary_output(primary != outputs.end() ? primary->second : nullptr);
+    }
+
+    // The backend state is the new base, against which only the user's changes remain.
+    setInitial(ConfigDiff::Snapshot(m_backendConfig));
+    for (auto const& [key, output] : outputs) {
+        updateDifferences(output, AllFields);
+    }
+
+    if (!mergedIds.isEmpty()) {
+        qCDebug(KDISPLAY_KCM) << "Merged backend changes of outputs" << mergedIds;
+        m_history.update(m_config, mergedIds);
+        m_outputs->refresh(mergedIds);
     }
-    if (width > 0 && height > 0) {
-        size = QSize(width, height);
+
+    m_editedOutputs.clear();
+    m_historyBlocked = false;
+
+    m_stale.needsSave = true;
+    m_stale.retention = true;
+    m_stale.changed = true;
+    scheduleRevalidation();
+
+    if (m_confirmingApplied) {
+        m_confirmingApplied = false;
+        Q_EMIT appliedConfirmed();
+    }
+}
+
+ConfigHistory::StatePtr ConfigHandler::initialOutput(const Disman::OutputPtr& output)
+{
+    auto it = m_initialOutputs.find(output->id());
+    if (it == m_initialOutputs.end()) {
+        it = m_initialOutputs.insert(output->id(), m_initial.outputs.value(output->hash()));
+    }
+    return *it;
+}
+
+void ConfigHandler::updateDifferences(const Disman::OutputPtr& output, Fields fields)
+{
+    m_editedOutputs.insert(output->id());
+
+    auto const initial = initialOutput(output);
+    if (!initial) {
+        // Outputs that are not in the initial configuration are not compared.
+        return;
+    }
+
+    if (fields & Field::Enabled) {
+        fields = AllFields;
+    }
+
+    auto differences = m_differences.value(output->id()) & ~fields;
+    differences |= ConfigDiff::compare(ConfigDiff::OutputState(output), *initial, fields);
+
+    if (differences) {
+        m_differences.insert(output->id(), differences);
     } else {
-        size = QSize();
+        m_differences.remove(output->id());
+    }
+}
+
+void ConfigHandler::removeDifferences(int outputId)
+{
+    m_initialOutputs.remove(outputId);
+    m_differences.remove(outputId);
+    m_editedOutputs.remove(outputId);
+    m_history.remove(outputId);
+}
+
+void ConfigHandler::recordHistory()
+{
+    if (m_historyBlocked) {
+        return;
+    }
+
+    auto const outputIds = std::move(m_editedOutputs);
+    m_editedOutputs = QSet<int>();
+    if (m_history.record(m_config, outputIds)) {
+        Q_EMIT historyChanged();
     }
-    return size;
+}
+
+void ConfigHandler::undo()
+{
+    if (m_history.canUndo()) {
+        restoreHistory(false);
+    }
+}
+
+void ConfigHandler::redo()
+{
+    if (m_history.canRedo()) {
+        restoreHistory(true);
+    }
+}
+
+void ConfigHandler::restoreHistory(bool redo)
+{
+    // Changing the primary output or positions makes the model send changes, which must not be
+    // recorded again.
+    m_historyBlocked = true;
+
+    auto const outputIds = redo ? m_history.redo(m_config) : m_history.undo(m_config);
+    auto const outputs = m_config->outputs();
+    for (auto id : outputIds) {
+        updateDifferences(outputs.at(id), AllFields);
+    }
+    m_outputs->refresh(outputIds);
+
+    m_editedOutputs.clear();
+    m_historyBlocked = false;
+
+    m_stale.needsSave = true;
+    m_stale.retention = true;
+    m_stale.changed = true;
+    scheduleRevalidation();
+    Q_EMIT historyChanged();
+}
+
+bool ConfigHandler::canUndo() const
+{
+    return m_history.canUndo();
+}
+
+bool ConfigHandler::canRedo() const
+{
+    return m_history.canRedo();
+}
+
+void ConfigHandler::checkNeedsSave()
+{
+    m_stale.needsSave = true;
+    scheduleRevalidation();
+}
+
+void ConfigHandler::scheduleRevalidation()
+{
+    if (m_revalidationScheduled) {
+        return;
+    }
+    m_revalidationScheduled = true;
+    QMetaObject::invokeMethod(this, &ConfigHandler::revalidate, Qt::QueuedConnection);
+}
+
+void ConfigHandler::revalidate()
+{
+    // Reset before emitting so receivers can schedule another pass from their slots.
+    auto const stale = m_stale;
+    m_stale = Stale();
+    m_revalidationScheduled = false;
+
+    if (!m_config) {
+        return;
+    }
+
+    if (stale.needsSave) {
+        updateNeedsSave();
+    }
+    if (stale.normalization) {
+        checkScreenNormalization();
+    }
+    if (stale.retention) {
+        if (auto const retention = ConfigHandler::retention(); retention != m_lastRetention) {
+            m_lastRetention = retention;
+            Q_EMIT retentionChanged();
+        }
+    }
+    if (stale.changed) {
+        Q_EMIT changed();
+    }
+}
+
+bool ConfigHandler::differsFromInitial() const
+{
+    return !m_differences.isEmpty() || ConfigDiff::primaryDiffers(m_config, m_initial);
+}
+
+ConfigDiff::Delta ConfigHandler::delta() const
+{
+    return ConfigDiff::compute(m_config, m_initial);
+}
+
+void ConfigHandler::updateNeedsSave()
+{
+    Q_EMIT needsSaveChecked(differsFromInitial());
+}
+
+QSize ConfigHandler::screenSize() const
+{
+    return m_outputs->screenSize();
 }
 
 QSize ConfigHandler::normalizeScreen()
@@ -168,6 +488,8 @@ QSize ConfigHandler::normalizeScreen()
     changed |= m_lastNormalizedScreenSize != currentScreenSize;
     m_lastNormalizedScreenSize = currentScreenSize;
 
+    // Already up to date for the pending revalidation.
+    m_stale.normalization = false;
     Q_EMIT screenNormalizationUpdate(true);
     return currentScreenSize;
 }
@@ -249,8 +571,11 @@ void ConfigHandler::setRetention(int retention)
     auto ret = static_cast<Retention>(retention);
     for (auto const& [key, output] : m_config->outputs()) {
         output->set_retention(ret);
+        updateDifferences(output, Field::Retention);
     }
-    checkNeedsSave();
-    Q_EMIT retentionChanged();
-    Q_EMIT changed();
+    recordHistory();
+    m_stale.needsSave = true;
+    m_stale.retention = true;
+    m_stale.changed = true;
+    scheduleRevalidation();
 }
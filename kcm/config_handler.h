@@ -16,9 +16,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #pragma once
 
+#include "config_history.h"
+
+#include "../common/config_diff.h"
+
 #include <disman/config.h>
 #include <disman/output.h>
 
+#include <QHash>
+#include <QSet>
+
 #include <memory>
 
 class OutputModel;
@@ -27,34 +34,87 @@ class ConfigHandler : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * Output properties that are compared with the initial configuration to decide if there is
+     * something to save.
+     */
+    using Field = ConfigDiff::Field;
+    using Fields = ConfigDiff::Fields;
+    static constexpr Fields AllFields = ConfigDiff::AllFields;
+
     explicit ConfigHandler(QObject* parent = nullptr);
     ~ConfigHandler() override = default;
 
     void setConfig(Disman::ConfigPtr config);
     void updateInitialData();
 
+    /**
+     * Records the current config as a step in the history before it is applied.
+     *
+     * @return the state of the config to be adopted with adoptAppliedConfig once applied.
+     */
+    ConfigDiff::Snapshot beginApply();
+    /**
+     * Takes @p applied as the initial state after it has been applied. Changes made since then
+     * remain as differences. Should the backend report back a different config afterwards its
+     * changes are merged.
+     */
+    void adoptAppliedConfig(ConfigDiff::Snapshot applied);
+    /**
+     * Stops waiting for the backend to report back an applied config, so a later report does
+     * not confirm it.
+     */
+    void cancelAppliedConfirmation();
+
     OutputModel* outputModel() const
     {
         return m_outputs;
     }
 
     QSize normalizeScreen();
+    QSize screenSize() const;
 
     Disman::ConfigPtr config() const
     {
         return m_config;
     }
 
-    Disman::ConfigPtr initialConfig() const
-    {
-        return m_initialConfig;
-    }
+    /**
+     * @return a copy of the current config with the initial state of the outputs. It is created
+     * on every call.
+     */
+    Disman::ConfigPtr initialConfig() const;
 
     int retention() const;
     void setRetention(int retention);
 
+    /**
+     * Schedules comparing the configuration with the initial one. The result is sent with the
+     * needsSaveChecked signal once control returns to the event loop.
+     */
     void checkNeedsSave();
 
+    /**
+     * Compares @p fields of @p output with the initial configuration again. Must be called after
+     * they might have changed. Changing whether the output is enabled compares all fields.
+     */
+    void updateDifferences(const Disman::OutputPtr& output, Fields fields);
+    void removeDifferences(int outputId);
+
+    /**
+     * @return changes of the current config in relation to the initial one.
+     */
+    ConfigDiff::Delta delta() const;
+
+    /**
+     * Reverts the last change or restores the last reverted one. Changes are recorded for each
+     * batch of changes sent by the output model.
+     */
+    void undo();
+    void redo();
+    bool canUndo() const;
+    bool canRedo() const;
+
 Q_SIGNALS:
     void outputModelChanged();
     void changed();
@@ -62,18 +122,84 @@ Q_SIGNALS:
     void needsSaveChecked(bool need);
     void retentionChanged();
     void outputConnect(bool connected);
+    void historyChanged();
+    /**
+     * Sent when the backend has reported back its state after the config was adopted as applied.
+     */
+    void appliedConfirmed();
 
 private:
+    friend class TestConfigHandler;
+
+    /**
+     * Derived state that is recomputed in one pass from the event loop after any number of
+     * changes, so each dependent signal is sent at most once per burst of changes.
+     */
+    struct Stale {
+        bool needsSave = false;
+        bool normalization = false;
+        bool retention = false;
+        bool changed = false;
+    };
+
+    void scheduleRevalidation();
+    void revalidate();
+    bool differsFromInitial() const;
+    void updateNeedsSave();
     void checkScreenNormalization();
-    QSize screenSize() const;
     Disman::Output::Retention getRetention() const;
     void primaryOutputSelected(int index);
     void primaryOutputChanged(const Disman::OutputPtr& output);
     void initOutput(const Disman::OutputPtr& output);
 
+    void setInitial(ConfigDiff::Snapshot initial);
+    /**
+     * Takes over changes reported by the backend into the fields of the current config that the
+     * user has not changed, and makes the reported state the new initial one.
+     */
+    void mergeBackendChanges();
+
+    /**
+     * Hotplugged outputs are added to and removed from the current config and the model in
+     * place, so views keep their delegates for the other outputs.
+     */
+    void backendOutputAdded(const Disman::OutputPtr& output);
+    void backendOutputRemoved(int outputId);
+    ConfigHistory::StatePtr initialOutput(const Disman::OutputPtr& output);
+
+    /**
+     * @return the latest recorded state of the current config, sharing the output states with
+     * the history.
+     */
+    ConfigDiff::Snapshot snapshot() const;
+    void recordHistory();
+    void restoreHistory(bool redo);
+
     Disman::ConfigPtr m_config = nullptr;
-    Disman::ConfigPtr m_initialConfig;
+    /** Updated by the config monitor with the state of the backend. */
+    Disman::ConfigPtr m_backendConfig;
     OutputModel* m_outputs = nullptr;
 
+    ConfigDiff::Snapshot m_initial;
+    /** Initial output states by id of the current output with the same hash, once looked up. */
+    QHash<int, ConfigHistory::StatePtr> m_initialOutputs;
+    /**
+     * Fields differing from the initial configuration by output id. Outputs without differences
+     * have no entry.
+     */
+    QHash<int, Fields> m_differences;
+
+    ConfigHistory m_history;
+    /** Outputs compared since the last recorded step. */
+    QSet<int> m_editedOutputs;
+    /** Set while the config is changed by other means than user edits. */
+    bool m_historyBlocked = false;
+    /** Whether the backend has not yet reported back since the config was applied. */
+    bool m_confirmingApplied = false;
+
     QSize m_lastNormalizedScreenSize;
+    int m_lastRetention = 0;
+
+    Stale m_stale;
+    bool m_revalidationScheduled = false;
 };
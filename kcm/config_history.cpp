@@ -0,0 +1,166 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "config_history.h"
+
+#include <disman/output.h>
+
+/** Oldest steps are dropped beyond this. */
+static const int s_maxSteps = 100;
+
+static int primaryId(const Disman::ConfigPtr& config)
+{
+    auto const primary = config->primary_output();
+    return primary ? primary->id() : 0;
+}
+
+void ConfigHistory::reset(const Disman::ConfigPtr& config)
+{
+    m_current.clear();
+    m_undo.clear();
+    m_redo.clear();
+
+    for (auto const& [key, output] : config->outputs()) {
+        m_current.insert(output->id(), std::make_shared<const ConfigDiff::OutputState>(output));
+    }
+    m_primaryId = primaryId(config);
+}
+
+bool ConfigHistory::record(const Disman::ConfigPtr& config, const QSet<int>& outputIds)
+{
+    Step step;
+    step.primaryBefore = m_primaryId;
+    step.primaryAfter = primaryId(config);
+
+    auto const outputs = config->outputs();
+    for (auto id : outputIds) {
+        auto const output = outputs.find(id);
+        if (output == outputs.end()) {
+            continue;
+        }
+
+        auto state = std::make_shared<const ConfigDiff::OutputState>(output->second);
+        auto current = m_current.find(id);
+        if (current == m_current.end()) {
+            // New outputs have nothing to revert to.
+            m_current.insert(id, state);
+            continue;
+        }
+        if (**current == *state) {
+            continue;
+        }
+        step.before.insert(id, *current);
+        step.after.insert(id, state);
+        // Fields of disabled outputs are not compared, so compare from both sides.
+        step.fields.insert(id,
+                           ConfigDiff::compare(*state, **current, ConfigDiff::AllFields)
+                               | ConfigDiff::compare(**current, *state, ConfigDiff::AllFields));
+        *current = std::move(state);
+    }
+
+    if (step.before.isEmpty() && step.primaryBefore == step.primaryAfter) {
+        return false;
+    }
+
+    m_primaryId = step.primaryAfter;
+    m_redo.clear();
+    if (m_undo.size() == s_maxSteps) {
+        m_undo.removeFirst();
+    }
+    m_undo.append(std::move(step));
+    return true;
+}
+
+void ConfigHistory::update(const Disman::ConfigPtr& config, const QVector<int>& outputIds)
+{
+    auto const outputs = config->outputs();
+    for (auto id : outputIds) {
+        if (auto const output = outputs.find(id); output != outputs.end()) {
+            m_current.insert(id, std::make_shared<const ConfigDiff::OutputState>(output->second));
+        }
+    }
+    m_primaryId = primaryId(config);
+}
+
+QVector<int> ConfigHistory::undo(const Disman::ConfigPtr& config)
+{
+    if (m_undo.isEmpty()) {
+        return {};
+    }
+
+    auto step = m_undo.takeLast();
+    auto const outputIds = restore(config, step.before, step.fields, step.primaryBefore);
+    m_redo.append(std::move(step));
+    return outputIds;
+}
+
+QVector<int> ConfigHistory::redo(const Disman::ConfigPtr& config)
+{
+    if (m_redo.isEmpty()) {
+        return {};
+    }
+
+    auto step = m_redo.takeLast();
+    auto const outputIds = restore(config, step.after, step.fields, step.primaryAfter);
+    m_undo.append(std::move(step));
+    return outputIds;
+}
+
+QVector<int> ConfigHistory::restore(const Disman::ConfigPtr& config,
+                                    const QHash<int, StatePtr>& states,
+                                    const QHash<int, ConfigDiff::Fields>& fields,
+                                    int primaryId)
+{
+    QVector<int> outputIds;
+    auto const outputs = config->outputs();
+
+    for (auto it = states.cbegin(); it != states.cend(); it++) {
+        auto const output = outputs.find(it.key());
+        if (output == outputs.end() || !m_current.contains(it.key())) {
+            // Removed since.
+            continue;
+        }
+        it.value()->apply(output->second, fields.value(it.key()));
+
+        // The stored state can be shared unless other fields have changed since.
+        ConfigDiff::OutputState const restored(output->second);
+        m_current.insert(it.key(),
+                         restored == *it.value()
+                             ? it.value()
+                             : std::make_shared<const ConfigDiff::OutputState>(restored));
+        outputIds.append(it.key());
+    }
+
+    if (primaryId != m_primaryId) {
+        auto const primary = outputs.find(primaryId);
+        if (primary != outputs.end()) {
+            config->set_primary_output(primary->second);
+        } else if (!primaryId) {
+            config->set_primary_output(nullptr);
+        }
+        m_primaryId = ::primaryId(config);
+    }
+    return outputIds;
+}
+
+bool ConfigHistory::canUndo() const
+{
+    return !m_undo.isEmpty();
+}
+
+bool ConfigHistory::canRedo() const
+{
+    return !m_redo.isEmpty();
+}
+
+ConfigHistory::StatePtr ConfigHistory::output(int outputId) const
+{
+    return m_current.value(outputId);
+}
+
+void ConfigHistory::remove(int outputId)
+{
+    m_current.remove(outputId);
+}
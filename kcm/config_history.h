@@ -0,0 +1,89 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "../common/config_diff.h"
+
+#include <disman/config.h>
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include <memory>
+
+/**
+ * Undo and redo steps for the changes made to a config. Every step only holds the states of the
+ * outputs it changed. States are immutable and shared between steps, and the modes of an output
+ * are never copied, so recording a step is linear in the number of changed outputs.
+ */
+class ConfigHistory
+{
+public:
+    using StatePtr = std::shared_ptr<const ConfigDiff::OutputState>;
+
+    /**
+     * Drops all steps and takes the current state of @p config as the latest one.
+     */
+    void reset(const Disman::ConfigPtr& config);
+
+    /**
+     * Compares the outputs with @p outputIds and the primary output of @p config with their
+     * latest states and pushes a step with the differences. Outputs without a state are taken
+     * as they are. Recording a step drops all redo steps.
+     *
+     * @return true if a step was recorded, otherwise false.
+     */
+    bool record(const Disman::ConfigPtr& config, const QSet<int>& outputIds);
+
+    /**
+     * Takes the current state of the outputs with @p outputIds and of the primary output of
+     * @p config without recording a step, for changes that are not made by the user.
+     */
+    void update(const Disman::ConfigPtr& config, const QVector<int>& outputIds);
+
+    /**
+     * Reverts @p config to the state before the last recorded step.
+     *
+     * @return ids of the outputs that were changed.
+     */
+    QVector<int> undo(const Disman::ConfigPtr& config);
+    QVector<int> redo(const Disman::ConfigPtr& config);
+
+    bool canUndo() const;
+    bool canRedo() const;
+
+    /**
+     * @return the latest state of the output with @p outputId or null if it has none.
+     */
+    StatePtr output(int outputId) const;
+    void remove(int outputId);
+
+private:
+    struct Step {
+        /** States of the changed outputs before and after the step by output id. */
+        QHash<int, StatePtr> before;
+        QHash<int, StatePtr> after;
+        /**
+         * Fields that differ between the states before and after the step. Only these are
+         * restored, so changes merged from elsewhere in the meantime are kept.
+         */
+        QHash<int, ConfigDiff::Fields> fields;
+        int primaryBefore = 0;
+        int primaryAfter = 0;
+    };
+
+    QVector<int> restore(const Disman::ConfigPtr& config,
+                         const QHash<int, StatePtr>& states,
+                         const QHash<int, ConfigDiff::Fields>& fields,
+                         int primaryId);
+
+    QHash<int, StatePtr> m_current;
+    int m_primaryId = 0;
+
+    QVector<Step> m_undo;
+    QVector<Step> m_redo;
+};
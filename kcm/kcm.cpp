@@ -17,9 +17,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "kcm.h"
 
 #include "../common/orientation_sensor.h"
+#include "../common/utils.h"
+#include "../common/x_resources.h"
 #include "config_handler.h"
 #include "kcm_kdisplay_debug.h"
 #include "output_identifier.h"
+#include "scale_settings.h"
 
 #include <disman/config.h>
 #include <disman/getconfigoperation.h>
@@ -27,12 +30,12 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <disman/output.h>
 #include <disman/setconfigoperation.h>
 
-#include <KConfigGroup>
 #include <KLocalizedString>
 #include <KPluginFactory>
-#include <KSharedConfig>
 
-#include <QProcess>
+#include <QDBusConnection>
+#include <QEventLoopLocker>
+#include <QThreadPool>
 #include <QTimer>
 
 K_PLUGIN_CLASS_WITH_JSON(KCMKDisplay, "kcm_kdisplay.json")
@@ -42,17 +45,38 @@ using namespace Disman;
 KCMKDisplay::KCMKDisplay(QObject* parent, KPluginMetaData const& data)
     : KQuickManagedConfigModule(parent, data)
 {
-    qmlRegisterAnonymousType<OutputModel>("org.kwinft.private.kcm.screen", 1);
-    qmlRegisterType<Disman::Output>("org.kwinft.private.kcm.kdisplay", 1, 0, "Output");
-
     Log::instance();
 
     setButtons(Apply);
 
-    m_loadCompressor = new QTimer(this);
-    m_loadCompressor->setInterval(1000);
-    m_loadCompressor->setSingleShot(true);
-    connect(m_loadCompressor, &QTimer::timeout, this, &KCMKDisplay::load);
+    m_outputIdentifier = std::make_unique<OutputIdentifier>();
+
+    m_topologyTimeout = new QTimer(this);
+    m_topologyTimeout->setInterval(3000);
+    m_topologyTimeout->setSingleShot(true);
+    connect(m_topologyTimeout, &QTimer::timeout, this, [this] {
+        qCDebug(KDISPLAY_KCM) << "Daemon did not report applied outputs in time.";
+        topologySettled();
+    });
+    m_confirmTimeout = new QTimer(this);
+    m_confirmTimeout->setInterval(3000);
+    m_confirmTimeout->setSingleShot(true);
+    connect(m_confirmTimeout, &QTimer::timeout, this, [this] {
+        qCDebug(KDISPLAY_KCM) << "Backend did not report back the applied config in time.";
+        if (m_config) {
+            m_config->cancelAppliedConfirmation();
+        }
+        setSaveState(Idle);
+    });
+    m_xResourcesPool = new QThreadPool(this);
+    m_xResourcesPool->setMaxThreadCount(1);
+
+    QDBusConnection::sessionBus().connect(QStringLiteral("org.kde.kded6"),
+                                          QStringLiteral("/modules/kdisplay"),
+                                          QStringLiteral("org.kwinft.kdisplay"),
+                                          QStringLiteral("topologyApplied"),
+                                          this,
+                                          SLOT(topologyApplied(QStringList)));
 
     m_orientationSensor = new OrientationSensor(this);
     connect(m_orientationSensor,
@@ -61,6 +85,17 @@ KCMKDisplay::KCMKDisplay(QObject* parent, KPluginMetaData const& data)
             &KCMKDisplay::orientationSensorAvailableChanged);
 }
 
+KCMKDisplay::~KCMKDisplay()
+{
+    // The module might be closed right after saving. The running operation keeps the application
+    // alive until the backend has received the config, only the result is of no interest anymore.
+    if (m_saveOperation) {
+        disconnect(m_saveOperation, nullptr, this, nullptr);
+    }
+    // A pending write of the X resources must not run past the unloading of the module.
+    m_xResourcesPool->waitForDone();
+}
+
 void KCMKDisplay::configReady(ConfigOperation* op)
 {
     qCDebug(KDISPLAY_KCM) << "Reading in config now.";
@@ -88,11 +123,21 @@ void KCMKDisplay::configReady(ConfigOperation* op)
 
 void KCMKDisplay::save()
 {
+    cancelSave();
+
+    if (m_topologyTimeout->isActive()) {
+        // The daemon is setting up the outputs. Its result is merged first.
+        qCDebug(KDISPLAY_KCM) << "Deferring save until the daemon has applied the outputs.";
+        m_saveAfterTopology = true;
+        return;
+    }
+
     if (!m_config) {
         Q_EMIT errorOnSave();
         return;
     }
 
+    setSaveState(Validating);
     auto config = m_config->config();
 
     if (auto primary = config->primary_output()) {
@@ -128,34 +173,123 @@ void KCMKDisplay::save()
     if (!atLeastOneEnabledOutput) {
         Q_EMIT invalidConfig(InvalidConfigReason::NoEnabledOutputs);
         m_config->checkNeedsSave();
+        setSaveState(Idle);
         return;
     }
 
     if (!Config::can_be_applied(config)) {
         Q_EMIT errorOnSave();
         m_config->checkNeedsSave();
+        setSaveState(Idle);
         return;
     }
 
     if (!perOutputScaling()) {
+        setSaveState(WritingGlobalScale);
         writeGlobalScale();
     }
 
-    // Store the current config, apply settings. Block until operation is
-    // completed, otherwise ConfigModule might terminate before we get to
-    // execute the Operation.
-    auto* op = new SetConfigOperation(config);
-    op->exec();
+    auto const delta = m_config->delta();
+    if (delta.isEmpty()) {
+        // For example only the global scale changed.
+        qCDebug(KDISPLAY_KCM) << "Config unchanged, nothing to apply.";
+        m_config->checkNeedsSave();
+        setSaveState(Idle);
+        return;
+    }
+    qCDebug(KDISPLAY_KCM) << "Applying" << delta;
+
+    // The user might continue editing while the config is applied. Only what is sent now
+    // becomes the new baseline.
+    setSaveState(Applying);
+    m_saveOperation = new SetConfigOperation(config->clone());
+
+    // The operation is started and talks to the backend from the event loop. When the window is
+    // closed right after saving, the application must keep running until it has finished or the
+    // config is lost. This does not depend on the module, which might be destroyed before.
+    auto const locker = new QEventLoopLocker;
+    connect(m_saveOperation, &ConfigOperation::finished, m_saveOperation, [locker] {
+        delete locker;
+    });
 
-    // The 1000ms is a legacy value tested to work for randr having
-    // enough time to change configuration.
-    QTimer::singleShot(1000, this, [this]() {
-        if (!m_config) {
-            setNeedsSave(false);
-            return;
-        }
+    connect(m_saveOperation,
+            &ConfigOperation::finished,
+            this,
+            [this, snapshot = m_config->beginApply()](ConfigOperation* op) {
+                applied(op, snapshot);
+            });
+}
+
+void KCMKDisplay::applied(ConfigOperation* op, const ConfigDiff::Snapshot& snapshot)
+{
+    m_saveOperation.clear();
+
+    if (op->has_error()) {
+        qCWarning(KDISPLAY_KCM) << "Applying config failed:" << op->error_string();
         m_config->updateInitialData();
-    });
+        setSaveState(Idle);
+        return;
+    }
+
+    // What we applied is the new baseline. Should the backend report back something different
+    // the config handler merges it. The save is done with that report.
+    setSaveState(Confirming);
+    m_confirmTimeout->start();
+    m_config->adoptAppliedConfig(snapshot);
+}
+
+void KCMKDisplay::topologyApplied(const QStringList& outputs)
+{
+    if (!m_config || outputs != Utils::outputHashes(m_config->config())) {
+        // The daemon might report before the outputs have changed here. The topology is settled
+        // once they have changed accordingly.
+        m_appliedTopology = outputs;
+        return;
+    }
+
+    m_appliedTopology.clear();
+    if (m_topologyTimeout->isActive()) {
+        m_topologyTimeout->stop();
+        topologySettled();
+    }
+}
+
+void KCMKDisplay::topologySettled()
+{
+    if (m_saveAfterTopology) {
+        m_saveAfterTopology = false;
+        save();
+    }
+}
+
+void KCMKDisplay::cancelSave()
+{
+    m_saveAfterTopology = false;
+    if (m_saveOperation) {
+        // The backend still receives the config, but a newer one follows.
+        qCDebug(KDISPLAY_KCM) << "Superseding running save.";
+        disconnect(m_saveOperation, nullptr, this, nullptr);
+        m_saveOperation.clear();
+    }
+    m_confirmTimeout->stop();
+    if (m_config) {
+        m_config->cancelAppliedConfirmation();
+    }
+    setSaveState(Idle);
+}
+
+KCMKDisplay::SaveState KCMKDisplay::saveState() const
+{
+    return m_saveState;
+}
+
+void KCMKDisplay::setSaveState(SaveState state)
+{
+    if (m_saveState == state) {
+        return;
+    }
+    m_saveState = state;
+    Q_EMIT saveStateChanged();
 }
 
 bool KCMKDisplay::backendReady() const
@@ -182,13 +316,12 @@ OutputModel* KCMKDisplay::outputModel() const
 
 void KCMKDisplay::identifyOutputs()
 {
-    if (!m_config || !m_config->initialConfig() || m_outputIdentifier) {
+    if (!m_config || m_outputIdentifier->isActive()) {
         return;
     }
-    m_outputIdentifier.reset(new OutputIdentifier(m_config->initialConfig(), this));
-    connect(m_outputIdentifier.get(), &OutputIdentifier::identifiersFinished, this, [this]() {
-        m_outputIdentifier.reset();
-    });
+    if (auto const config = m_config->initialConfig()) {
+        m_outputIdentifier->identify(config);
+    }
 }
 
 QSize KCMKDisplay::normalizeScreen() const
@@ -199,6 +332,38 @@ QSize KCMKDisplay::normalizeScreen() const
     return m_config->normalizeScreen();
 }
 
+QSize KCMKDisplay::screenSize() const
+{
+    if (!m_config) {
+        return QSize();
+    }
+    return m_config->screenSize();
+}
+
+void KCMKDisplay::undo()
+{
+    if (m_config) {
+        m_config->undo();
+    }
+}
+
+void KCMKDisplay::redo()
+{
+    if (m_config) {
+        m_config->redo();
+    }
+}
+
+bool KCMKDisplay::canUndo() const
+{
+    return m_config && m_config->canUndo();
+}
+
+bool KCMKDisplay::canRedo() const
+{
+    return m_config && m_config->canRedo();
+}
+
 bool KCMKDisplay::screenNormalized() const
 {
     return m_screenNormalized;
@@ -288,6 +453,7 @@ void KCMKDisplay::load()
     // signal its disappearance first before deleting and replacing it.
     // We take the m_config pointer so outputModel() will return null,
     // gracefully cleaning up the QML side and only then we will delete it.
+    cancelSave();
     auto* oldConfig = m_config.release();
     if (oldConfig) {
         Q_EMIT outputModelChanged();
@@ -297,14 +463,22 @@ void KCMKDisplay::load()
     m_config.reset(new ConfigHandler(this));
     Q_EMIT perOutputScalingChanged();
     Q_EMIT supports_adaptive_sync_changed();
+    Q_EMIT historyChanged();
     connect(
         m_config.get(), &ConfigHandler::outputModelChanged, this, &KCMKDisplay::outputModelChanged);
+    // Hotplugged outputs are added and removed in place. Values the daemon sets for them
+    // afterwards are merged like any other change of the backend.
     connect(m_config.get(), &ConfigHandler::outputConnect, this, [this](bool connected) {
+        if (!m_appliedTopology.isEmpty()
+            && m_appliedTopology == Utils::outputHashes(m_config->config())) {
+            // The daemon has already reported these outputs.
+            m_appliedTopology.clear();
+            m_topologyTimeout->stop();
+            topologySettled();
+        } else {
+            m_topologyTimeout->start();
+        }
         Q_EMIT outputConnect(connected);
-        setBackendReady(false);
-
-        // Reload settings delayed such that daemon can update output values.
-        m_loadCompressor->start();
     });
     connect(m_config.get(),
             &ConfigHandler::screenNormalizationUpdate,
@@ -315,15 +489,21 @@ void KCMKDisplay::load()
             this,
             &KCMKDisplay::outputRetentionChanged);
 
-    // This is a queued connection so that we can fire the event from
-    // within the save() call in case it failed.
+    // The check is already deferred by the config handler, so this is fired from the event loop
+    // also when requested from within the save() call in case it failed.
     connect(m_config.get(),
             &ConfigHandler::needsSaveChecked,
             this,
-            &KCMKDisplay::continueNeedsSaveCheck,
-            Qt::QueuedConnection);
+            &KCMKDisplay::continueNeedsSaveCheck);
 
     connect(m_config.get(), &ConfigHandler::changed, this, &KCMKDisplay::changed);
+    connect(m_config.get(), &ConfigHandler::historyChanged, this, &KCMKDisplay::historyChanged);
+    connect(m_config.get(), &ConfigHandler::appliedConfirmed, this, [this] {
+        if (m_saveState == Confirming) {
+            m_confirmTimeout->stop();
+            setSaveState(Idle);
+        }
+    });
 
     connect(
         new GetConfigOperation(), &GetConfigOperation::finished, this, &KCMKDisplay::configReady);
@@ -342,8 +522,7 @@ void KCMKDisplay::continueNeedsSaveCheck(bool needs)
 
 void KCMKDisplay::fetchGlobalScale()
 {
-    const auto config = KSharedConfig::openConfig(QStringLiteral("kdeglobals"));
-    const qreal scale = config->group("KScreen").readEntry("ScaleFactor", 1.0);
+    auto const scale = ScaleSettings::read();
     m_initialGlobalScale = scale;
     setGlobalScale(scale);
 }
@@ -353,68 +532,20 @@ void KCMKDisplay::writeGlobalScale()
     if (qFuzzyCompare(m_initialGlobalScale, m_globalScale)) {
         return;
     }
-    auto config = KSharedConfig::openConfig(QStringLiteral("kdeglobals"));
-    config->group("KScreen").writeEntry("ScaleFactor", m_globalScale);
 
-    // Write env var to be used by session startup scripts to populate the QT_SCREEN_SCALE_FACTORS
-    // env var.
-    // We use QT_SCREEN_SCALE_FACTORS as opposed to QT_SCALE_FACTOR as we need to use one that will
-    // NOT scale fonts according to the scale.
-    // Scaling the fonts makes sense if you don't also set a font DPI, but we NEED to set a font
-    // DPI for both PlasmaShell which does it's own thing, and for KDE4/GTK2 applications.
-    QString screenFactors;
+    QStringList outputNames;
     for (auto const& [key, output] : m_config->config()->outputs()) {
-        screenFactors.append(QString::fromStdString(output->name()) + QLatin1Char('=')
-                             + QString::number(m_globalScale) + QLatin1Char(';'));
-    }
-    config->group("KScreen").writeEntry("ScreenScaleFactors", screenFactors);
-
-    KConfig fontConfig(QStringLiteral("kcmfonts"));
-    auto fontConfigGroup = fontConfig.group("General");
-
-    if (qFuzzyCompare(m_globalScale, 1.0)) {
-        // if dpi is the default (96) remove the entry rather than setting it
-        QProcess queryProc;
-        queryProc.start(QStringLiteral("xrdb"), {QStringLiteral("-query")});
-        if (queryProc.waitForFinished()) {
-            QByteArray db = queryProc.readAllStandardOutput();
-            int idx1 = 0;
-            while (idx1 < db.size()) {
-                int idx2 = db.indexOf('\n', idx1);
-                if (idx2 == -1) {
-                    idx2 = db.size() - 1;
-                }
-                const auto entry = QByteArray::fromRawData(db.constData() + idx1, idx2 - idx1 + 1);
-                if (entry.startsWith("Xft.dpi:")) {
-                    db.remove(idx1, entry.size());
-                } else {
-                    idx1 = idx2 + 1;
-                }
-            }
-
-            QProcess loadProc;
-            loadProc.start(
-                QStringLiteral("xrdb"),
-                {QStringLiteral("-quiet"), QStringLiteral("-load"), QStringLiteral("-nocpp")});
-            if (loadProc.waitForStarted()) {
-                loadProc.write(db);
-                loadProc.closeWriteChannel();
-                loadProc.waitForFinished();
-            }
-        }
-        fontConfigGroup.writeEntry("forceFontDPI", 0);
-    } else {
-        const int scaleDpi = qRound(m_globalScale * 96.0);
-        QProcess proc;
-        proc.start(QStringLiteral("xrdb"),
-                   {QStringLiteral("-quiet"), QStringLiteral("-merge"), QStringLiteral("-nocpp")});
-        if (proc.waitForStarted()) {
-            proc.write(QByteArray("Xft.dpi: " + QString::number(scaleDpi).toLatin1()));
-            proc.closeWriteChannel();
-            proc.waitForFinished();
-        }
-        fontConfigGroup.writeEntry("forceFontDPI", scaleDpi);
+        outputNames.append(QString::fromStdString(output->name()));
     }
+    auto const scaleDpi = ScaleSettings::write(m_globalScale, outputNames);
+
+    // Updating the X resources takes a round trip to the X server, which should not block the
+    // view. It is finished on destruction when the module is closed in between.
+    m_xResourcesPool->start([scaleDpi] {
+        if (!XResources::writeXftDpi(scaleDpi)) {
+            qCWarning(KDISPLAY_KCM) << "Could not write Xft.dpi to the X resources.";
+        }
+    });
 
     m_initialGlobalScale = m_globalScale;
     Q_EMIT globalScaleWritten();
@@ -18,13 +18,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "output_model.h"
 
+#include "../common/config_diff.h"
+
 #include <KQuickManagedConfigModule>
 
+#include <QPointer>
+#include <qqmlintegration.h>
+
+class QThreadPool;
 class QTimer;
 
 namespace Disman
 {
 class ConfigOperation;
+class SetConfigOperation;
 }
 
 class ConfigHandler;
@@ -34,6 +41,8 @@ class OutputIdentifier;
 class KCMKDisplay : public KQuickManagedConfigModule
 {
     Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("The module is provided as kcm.")
 
     Q_PROPERTY(OutputModel* outputModel READ outputModel NOTIFY outputModelChanged)
     Q_PROPERTY(bool backendReady READ backendReady NOTIFY backendReadyChanged)
@@ -53,6 +62,9 @@ class KCMKDisplay : public KQuickManagedConfigModule
     Q_PROPERTY(bool orientationSensorAvailable READ orientationSensorAvailable NOTIFY
                    orientationSensorAvailableChanged)
     Q_PROPERTY(bool tabletModeAvailable READ tabletModeAvailable NOTIFY tabletModeAvailableChanged)
+    Q_PROPERTY(bool canUndo READ canUndo NOTIFY historyChanged)
+    Q_PROPERTY(bool canRedo READ canRedo NOTIFY historyChanged)
+    Q_PROPERTY(SaveState saveState READ saveState NOTIFY saveStateChanged)
 
 public:
     enum InvalidConfigReason {
@@ -61,8 +73,21 @@ public:
     };
     Q_ENUM(InvalidConfigReason)
 
+    /**
+     * Progress of a save. Saves do not block, the config is applied in the background and the
+     * save is only done once the backend has reported back the resulting state.
+     */
+    enum SaveState {
+        Idle,
+        Validating,
+        WritingGlobalScale,
+        Applying,
+        Confirming,
+    };
+    Q_ENUM(SaveState)
+
     KCMKDisplay(QObject* parent, KPluginMetaData const& data);
-    ~KCMKDisplay() override = default;
+    ~KCMKDisplay() override;
 
     void load() override;
     void save() override;
@@ -75,6 +100,11 @@ public:
     bool backendReady() const;
 
     Q_INVOKABLE QSize normalizeScreen() const;
+    /**
+     * @return size of the screen spanned by the outputs. Unlike normalizeScreen() this does not
+     * change any state.
+     */
+    Q_INVOKABLE QSize screenSize() const;
     bool screenNormalized() const;
 
     bool perOutputScaling() const;
@@ -92,6 +122,13 @@ public:
     bool orientationSensorAvailable() const;
     bool tabletModeAvailable() const;
 
+    Q_INVOKABLE void undo();
+    Q_INVOKABLE void redo();
+    bool canUndo() const;
+    bool canRedo() const;
+
+    SaveState saveState() const;
+
 Q_SIGNALS:
     void backendReadyChanged();
     void backendError();
@@ -111,6 +148,11 @@ Q_SIGNALS:
     void errorOnSave();
     void globalScaleWritten();
     void outputConnect(bool connected);
+    void historyChanged();
+    void saveStateChanged();
+
+private Q_SLOTS:
+    void topologyApplied(const QStringList& outputs);
 
 private:
     void setBackendReady(bool error);
@@ -120,6 +162,10 @@ private:
     void writeGlobalScale();
 
     void configReady(Disman::ConfigOperation* op);
+    void setSaveState(SaveState state);
+    void applied(Disman::ConfigOperation* op, const ConfigDiff::Snapshot& snapshot);
+    void cancelSave();
+    void topologySettled();
     void continueNeedsSaveCheck(bool needs);
 
     std::unique_ptr<OutputIdentifier> m_outputIdentifier;
@@ -130,5 +176,24 @@ private:
     double m_globalScale = 1.;
     double m_initialGlobalScale = 1.;
 
-    QTimer* m_loadCompressor;
+    SaveState m_saveState = Idle;
+    /** Operation of the running save. It is dropped when a newer save supersedes it. */
+    QPointer<Disman::SetConfigOperation> m_saveOperation;
+
+    /**
+     * Runs while the daemon sets up connected or disconnected outputs, until it reports to be
+     * done or as fallback when it does not report back in time.
+     */
+    QTimer* m_topologyTimeout;
+    /** Whether a save was requested while the daemon was setting up outputs. */
+    bool m_saveAfterTopology = false;
+    /** Outputs the daemon reported as applied before they were connected or disconnected here. */
+    QStringList m_appliedTopology;
+    /**
+     * Runs while waiting for the backend to report back an applied config. Changes it does not
+     * report, for example of the retention only, would otherwise never end the save.
+     */
+    QTimer* m_confirmTimeout;
+    /** Writes the X resources off the main thread. A single thread keeps writes in order. */
+    QThreadPool* m_xResourcesPool;
 };
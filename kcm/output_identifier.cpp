@@ -16,48 +16,166 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *********************************************************************/
 #include "output_identifier.h"
 
+#include "raster_identifier.h"
+
+#include "kcm_kdisplay_debug.h"
+
 #include "../common/utils.h"
 
 #include <disman/output.h>
 
+#include <QQmlComponent>
+#include <QQmlEngine>
 #include <QQuickItem>
-#include <QQuickView>
-#include <QStandardPaths>
+#include <QQuickWindow>
 #include <QSurfaceFormat>
 #include <QTimer>
 
-#define QML_PATH "kpackage/kcms/kcm_kdisplay/contents/ui/"
+#define QML_PATH "qrc:/kcm/kcm_kdisplay/"
+
+/** How long identifiers are shown. */
+static const int s_showTime = 2500;
+/** How long the engine and windows are kept for reuse after identifiers were hidden. */
+static const int s_idleTime = 60000;
 
-OutputIdentifier::OutputIdentifier(Disman::ConfigPtr config, QObject* parent)
+OutputIdentifier::OutputIdentifier(QObject* parent)
     : QObject(parent)
+    , m_raster(qEnvironmentVariable("KDISPLAY_IDENTIFIER") == QLatin1String("raster")
+               || QQuickWindow::sceneGraphBackend() == QLatin1String("software"))
+    , m_hideTimer(new QTimer(this))
+    , m_releaseTimer(new QTimer(this))
+{
+    m_hideTimer->setInterval(s_showTime);
+    m_hideTimer->setSingleShot(true);
+    connect(m_hideTimer, &QTimer::timeout, this, &OutputIdentifier::hide);
+
+    m_releaseTimer->setInterval(s_idleTime);
+    m_releaseTimer->setSingleShot(true);
+    connect(m_releaseTimer, &QTimer::timeout, this, &OutputIdentifier::release);
+}
+
+OutputIdentifier::~OutputIdentifier()
+{
+    release();
+}
+
+bool OutputIdentifier::isActive() const
+{
+    return m_hideTimer->isActive();
+}
+
+bool OutputIdentifier::createComponent()
 {
+    if (m_raster) {
+        return true;
+    }
+    if (m_component) {
+        return true;
+    }
+
     QQuickWindow::setDefaultAlphaBuffer(true);
-    const QString qmlPath = QStandardPaths::locate(QStandardPaths::GenericDataLocation,
-                                                   QStringLiteral(QML_PATH "OutputIdentifier.qml"));
 
-    for (auto const& [key, output] : config->outputs()) {
-        if (!output->auto_mode()) {
-            continue;
+    m_engine = new QQmlEngine(this);
+    m_component = new QQmlComponent(
+        m_engine, QUrl(QStringLiteral(QML_PATH "OutputIdentifier.qml")), m_engine);
+    if (!m_component->isReady()) {
+        qCWarning(KDISPLAY_KCM) << "Could not load output identifier:" << m_component->errors();
+        // The engine owns the component. Drop both so the next request tries again.
+        delete m_engine;
+        m_engine = nullptr;
+        m_component = nullptr;
+        return false;
+    }
+    return true;
+}
+
+OutputIdentifier::Identifier* OutputIdentifier::identifier(int index)
+{
+    if (index < m_identifiers.size()) {
+        return &m_identifiers[index];
+    }
+    if (m_raster) {
+        return rasterIdentifier();
+    }
+
+    auto item = qobject_cast<QQuickItem*>(m_component->create());
+    if (!item) {
+        return nullptr;
+    }
+
+    auto window = new QQuickWindow;
+    QSurfaceFormat format;
+    format.setAlphaBufferSize(8);
+    window->setFormat(format);
+    window->setColor(QColor(0, 0, 0, 0));
+    window->setFlags(Qt::X11BypassWindowManagerHint | Qt::FramelessWindowHint);
+    item->setParent(window);
+    item->setParentItem(window->contentItem());
+
+    m_identifiers.append({window, item, QRect()});
+
+    // The size of the item follows its labels.
+    auto const resize = [this, window] {
+        for (auto const& identifier : std::as_const(m_identifiers)) {
+            if (identifier.window == window) {
+                center(identifier);
+            }
         }
+    };
+    connect(item, &QQuickItem::widthChanged, this, resize);
+    connect(item, &QQuickItem::heightChanged, this, resize);
 
-        auto const mode = output->auto_mode();
+    return &m_identifiers.last();
+}
 
-        auto view = new QQuickView;
-        QSurfaceFormat format;
-        format.setAlphaBufferSize(8);
-        view->setFormat(format);
-        view->setColor(QColor(0, 0, 0, 0));
-        view->setFlags(Qt::X11BypassWindowManagerHint | Qt::FramelessWindowHint);
-        view->setSource(QUrl::fromLocalFile(qmlPath));
+OutputIdentifier::Identifier* OutputIdentifier::rasterIdentifier()
+{
+    auto window = new RasterIdentifier;
+    m_identifiers.append({window, nullptr, QRect()});
+
+    // The window resizes itself to its labels.
+    auto const resize = [this, window] {
+        for (auto const& identifier : std::as_const(m_identifiers)) {
+            if (identifier.window == window) {
+                center(identifier);
+            }
+        }
+    };
+    connect(window, &QWindow::widthChanged, this, resize);
+    connect(window, &QWindow::heightChanged, this, resize);
+
+    return &m_identifiers.last();
+}
+
+void OutputIdentifier::center(const Identifier& identifier)
+{
+    auto const size
+        = identifier.item ? identifier.item->size().toSize() : identifier.window->size();
+    QRect geometry(QPoint(0, 0), size);
+    geometry.moveCenter(identifier.screen.center());
+    identifier.window->setGeometry(geometry);
+}
 
-        view->installEventFilter(this);
+void OutputIdentifier::identify(const Disman::ConfigPtr& config)
+{
+    if (isActive() || !createComponent()) {
+        return;
+    }
+    m_releaseTimer->stop();
 
-        auto rootObj = view->rootObject();
-        if (!rootObj) {
-            delete view;
+    m_shown = 0;
+    for (auto const& [key, output] : config->outputs()) {
+        auto const mode = output->auto_mode();
+        if (!mode) {
             continue;
         }
 
+        auto identifier = this->identifier(m_shown);
+        if (!identifier) {
+            break;
+        }
+        m_shown++;
+
         QSize deviceSize;
         QSizeF logicalSize;
         if (output->horizontal()) {
@@ -69,35 +187,44 @@ OutputIdentifier::OutputIdentifier(Disman::ConfigPtr config, QObject* parent)
             // Scale adjustment is not needed on Wayland, we use logical size.
             logicalSize = output->geometry().size();
         } else {
-            logicalSize = deviceSize / view->effectiveDevicePixelRatio();
+            logicalSize = deviceSize / identifier->window->effectiveDevicePixelRatio();
+        }
+        identifier->screen = QRectF(output->position(), logicalSize).toRect();
+        QObject* labels = identifier->item;
+        if (!labels) {
+            labels = identifier->window;
         }
-        rootObj->setProperty("outputName", Utils::outputName(output));
-        rootObj->setProperty("modeName", Utils::sizeToString(deviceSize));
-        view->setProperty("screenSize", QRectF(output->position(), logicalSize).toRect());
-        m_views << view;
+        labels->setProperty("outputName", Utils::outputName(output));
+        labels->setProperty("modeName", Utils::sizeToString(deviceSize));
+        center(*identifier);
     }
 
-    for (auto* view : m_views) {
-        view->show();
+    for (int i = 0; i < m_shown; i++) {
+        m_identifiers[i].window->show();
     }
-    QTimer::singleShot(2500, this, &OutputIdentifier::identifiersFinished);
+    m_hideTimer->start();
 }
 
-OutputIdentifier::~OutputIdentifier()
+void OutputIdentifier::hide()
 {
-    qDeleteAll(m_views);
+    for (auto const& identifier : std::as_const(m_identifiers)) {
+        identifier.window->hide();
+    }
+    m_shown = 0;
+    m_releaseTimer->start();
+    Q_EMIT identifiersFinished();
 }
 
-bool OutputIdentifier::eventFilter(QObject* object, QEvent* event)
+void OutputIdentifier::release()
 {
-    if (event->type() == QEvent::Resize) {
-        if (m_views.contains(qobject_cast<QQuickView*>(object))) {
-            QResizeEvent* e = static_cast<QResizeEvent*>(event);
-            const QRect screenSize = object->property("screenSize").toRect();
-            QRect geometry(QPoint(0, 0), e->size());
-            geometry.moveCenter(screenSize.center());
-            static_cast<QQuickView*>(object)->setGeometry(geometry);
-        }
+    for (auto const& identifier : std::as_const(m_identifiers)) {
+        // Deletes a QML item too, which must go before the engine.
+        delete identifier.window;
     }
-    return QObject::eventFilter(object, event);
+    m_identifiers.clear();
+    m_shown = 0;
+
+    delete m_engine;
+    m_engine = nullptr;
+    m_component = nullptr;
 }
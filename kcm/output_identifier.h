@@ -18,24 +18,65 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <disman/config.h>
 
+#include <QRect>
 #include <QVector>
 
-class QQuickView;
+class QQmlComponent;
+class QQmlEngine;
+class QQuickItem;
+class QTimer;
+class QWindow;
 
+/**
+ * Shows the name and mode of each output on it for a moment. The QML engine, the compiled
+ * identifier component and the windows are kept and reused for later calls until they have not
+ * been needed for a while.
+ *
+ * Instead of the QML identifiers windows painting the same labels with QPainter are used when
+ * the environment variable KDISPLAY_IDENTIFIER is set to "raster" or Qt Quick renders in
+ * software anyway. This path needs neither a QML engine nor a scene graph.
+ */
 class OutputIdentifier : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit OutputIdentifier(Disman::ConfigPtr config, QObject* parent = nullptr);
+    explicit OutputIdentifier(QObject* parent = nullptr);
     ~OutputIdentifier() override;
 
+    /**
+     * Shows identifiers for the outputs of @p config. Does nothing while they are shown.
+     */
+    void identify(const Disman::ConfigPtr& config);
+    bool isActive() const;
+
 Q_SIGNALS:
     void identifiersFinished();
 
-protected:
-    bool eventFilter(QObject* object, QEvent* event) override;
-
 private:
-    QVector<QQuickView*> m_views;
+    struct Identifier {
+        QWindow* window;
+        /** The QML identifier or null on the raster path. */
+        QQuickItem* item;
+        /** Logical geometry of the output to center the window on. */
+        QRect screen;
+    };
+
+    bool createComponent();
+    Identifier* identifier(int index);
+    Identifier* rasterIdentifier();
+    void center(const Identifier& identifier);
+    void hide();
+    void release();
+
+    bool m_raster;
+    QQmlEngine* m_engine = nullptr;
+    QQmlComponent* m_component = nullptr;
+
+    /** Pooled identifiers, the first ones of them are shown. */
+    QVector<Identifier> m_identifiers;
+    int m_shown = 0;
+
+    QTimer* m_hideTimer;
+    QTimer* m_releaseTimer;
 };
@@ -24,11 +24,22 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <QRect>
 
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
 OutputModel::OutputModel(ConfigHandler* configHandler)
     : QAbstractListModel(configHandler)
     , m_config(configHandler)
 {
-    connect(this, &OutputModel::dataChanged, this, &OutputModel::changed);
+    auto const& config = m_config->config();
+    if (auto const primary = config->primary_output()) {
+        m_primaryId = primary->id();
+    }
+    connect(config.get(),
+            &Disman::Config::primary_output_changed,
+            this,
+            &OutputModel::primaryOutputChanged);
 }
 
 int OutputModel::rowCount(const QModelIndex& parent) const
@@ -46,7 +57,7 @@ QVariant OutputModel::data(const QModelIndex& index, int role) const
     const Disman::OutputPtr& output = m_outputs[index.row()].ptr;
     switch (role) {
     case Qt::DisplayRole:
-        return Utils::outputName(output);
+        return m_names.value(output->id());
     case EnabledRole:
         return output->enabled();
     case InternalRole:
@@ -54,11 +65,15 @@ QVariant OutputModel::data(const QModelIndex& index, int role) const
     case PrimaryRole:
         return m_config->config() && m_config->config()->primary_output() == output;
     case SizeRole:
-        return output->geometry().size();
+        return m_geometries.size[index.row()];
     case PositionRole:
-        return m_outputs[index.row()].pos;
+        return m_geometries.pos[index.row()];
     case NormalizedPositionRole:
-        return output->geometry().topLeft();
+        if (output->id() == m_dragId) {
+            // The backend position is only updated on release.
+            return m_geometries.pos[index.row()] - originDelta();
+        }
+        return m_geometries.backendPos[index.row()];
     case AutoResolutionRole:
         return output->auto_resolution();
     case AutoRefreshRateRole:
@@ -83,26 +98,14 @@ QVariant OutputModel::data(const QModelIndex& index, int role) const
         return replicationSourceIndex(index.row());
     case ReplicasModelRole:
         return replicasModel(output);
-    case RefreshRatesRole: {
-        QVariantList ret;
-        for (auto rate : refreshRates(output)) {
-            if (output->auto_refresh_rate()) {
-                // We just show rounded values when not manual selecting a rate.
-                ret << i18nc("Approximate refresh rate in Hz (rounded to integer)",
-                             "≈ %1 Hz",
-                             static_cast<int>(rate / 1000. + 0.5));
-            } else {
-                ret << i18nc("Refresh rate in Hz (rounded to 3 digits)",
-                             "%1 Hz",
-                             static_cast<double>(rate / 1000.));
-            }
-        }
-        return ret;
-    }
+    case RefreshRatesRole:
+        return refreshRatesStrings(output);
     case AdaptiveSyncToggleSupportRole:
         return output->adaptive_sync_toggle_support();
     case AdaptiveSyncRole:
         return output->adaptive_sync();
+    case InteractiveMoveRole:
+        return output->id() == m_dragId;
     }
     return QVariant();
 }
@@ -113,26 +116,29 @@ bool OutputModel::setData(const QModelIndex& index, const QVariant& value, int r
         return false;
     }
 
-    Output& output = m_outputs[index.row()];
+    beginChanges();
+    auto const changed = setOutputData(index.row(), value, role);
+    commitChanges();
+    return changed;
+}
+
+bool OutputModel::setOutputData(int outputIndex, const QVariant& value, int role)
+{
+    Output& output = m_outputs[outputIndex];
     switch (role) {
     case PositionRole:
         if (value.canConvert<QPoint>()) {
-            QPoint val = value.toPoint();
-            if (output.pos == val) {
-                return false;
-            }
-
-            snap(output, val);
-            m_outputs[index.row()].pos = val;
-            updatePositions();
-            Q_EMIT positionChanged();
-            Q_EMIT dataChanged(index, index, {role});
-            return true;
+            return setPosition(outputIndex, value.toPoint());
+        }
+        break;
+    case InteractiveMoveRole:
+        if (value.canConvert<bool>()) {
+            return setInteractiveMove(outputIndex, value.toBool());
         }
         break;
     case EnabledRole:
         if (value.canConvert<bool>()) {
-            return setEnabled(index.row(), value.toBool());
+            return setEnabled(outputIndex, value.toBool());
         }
         break;
     case PrimaryRole:
@@ -142,48 +148,48 @@ bool OutputModel::setData(const QModelIndex& index, const QVariant& value, int r
                 return false;
             }
             m_config->config()->set_primary_output(output.ptr);
-            Q_EMIT dataChanged(index, index, {role});
+            notifyChanged(outputIndex, {role});
             return true;
         }
         break;
     case ResolutionIndexRole:
         if (value.canConvert<int>()) {
-            return setResolution(index.row(), value.toInt());
+            return setResolution(outputIndex, value.toInt());
         }
         break;
     case RefreshRateIndexRole:
         if (value.canConvert<int>()) {
-            return setRefreshRate(index.row(), value.toInt());
+            return setRefreshRate(outputIndex, value.toInt());
         }
         break;
     case AutoResolutionRole:
         if (value.canConvert<bool>()) {
-            return setAutoResolution(index.row(), value.value<bool>());
+            return setAutoResolution(outputIndex, value.value<bool>());
         }
         break;
     case AutoRefreshRateRole:
         if (value.canConvert<bool>()) {
-            return setAutoRefreshRate(index.row(), value.value<bool>());
+            return setAutoRefreshRate(outputIndex, value.value<bool>());
         }
         break;
     case AutoRotateRole:
         if (value.canConvert<bool>()) {
-            return setAutoRotate(index.row(), value.value<bool>());
+            return setAutoRotate(outputIndex, value.value<bool>());
         }
         break;
     case AutoRotateOnlyInTabletModeRole:
         if (value.canConvert<bool>()) {
-            return setAutoRotateOnlyInTabletMode(index.row(), value.value<bool>());
+            return setAutoRotateOnlyInTabletMode(outputIndex, value.value<bool>());
         }
         break;
     case RotationRole:
         if (value.canConvert<Disman::Output::Rotation>()) {
-            return setRotation(index.row(), value.value<Disman::Output::Rotation>());
+            return setRotation(outputIndex, value.value<Disman::Output::Rotation>());
         }
         break;
     case ReplicationSourceIndexRole:
         if (value.canConvert<int>()) {
-            return setReplicationSourceIndex(index.row(), value.toInt() - 1);
+            return setReplicationSourceIndex(outputIndex, value.toInt() - 1);
         }
         break;
     case ScaleRole: {
@@ -191,15 +197,16 @@ bool OutputModel::setData(const QModelIndex& index, const QVariant& value, int r
         const qreal scale = value.toReal(&ok);
         if (ok && !qFuzzyCompare(output.ptr->scale(), scale)) {
             output.ptr->set_scale(scale);
-            Q_EMIT sizeChanged();
-            Q_EMIT dataChanged(index, index, {role, SizeRole});
+            updateGeometry(outputIndex);
+            notifyChanged(outputIndex, {role, SizeRole});
+            m_changes.size = true;
             return true;
         }
         break;
     }
     case AdaptiveSyncRole:
         if (value.canConvert<bool>()) {
-            return set_adaptive_sync(index.row(), value.value<bool>());
+            return set_adaptive_sync(outputIndex, value.value<bool>());
         }
         break;
     }
@@ -230,17 +237,17 @@ QHash<int, QByteArray> OutputModel::roleNames() const
     roles[ReplicasModelRole] = "replicasModel";
     roles[AdaptiveSyncToggleSupportRole] = "adaptiveSyncToggleSupport";
     roles[AdaptiveSyncRole] = "adaptiveSync";
+    roles[InteractiveMoveRole] = "interactiveMove";
     return roles;
 }
 
 void OutputModel::add(const Disman::OutputPtr& output)
 {
-    const int insertPos = m_outputs.count();
-    beginInsertRows(QModelIndex(), insertPos, insertPos);
+    beginChanges();
 
     int i = 0;
     while (i < m_outputs.size()) {
-        auto const pos = m_outputs[i].ptr->position();
+        auto const& pos = m_geometries.backendPos[i];
         if (output->position().x() < pos.x()) {
             break;
         }
@@ -249,19 +256,27 @@ void OutputModel::add(const Disman::OutputPtr& output)
         }
         i++;
     }
+    beginInsertRows(QModelIndex(), i, i);
+
     // Set the initial non-normalized position to be the normalized
     // position plus the current delta.
     auto pos = output->position();
     if (!m_outputs.isEmpty()) {
-        auto const delta = m_outputs[0].pos - m_outputs[0].ptr->position();
+        auto const delta = m_geometries.pos[0] - m_geometries.backendPos[0];
         pos = output->position() + delta;
     }
-    m_outputs.insert(i, Output(output, pos));
-
-    connect(m_config->config().get(),
-            &Disman::Config::primary_output_changed,
-            this,
-            [this, output] { roleChanged(output->id(), PrimaryRole); });
+    m_outputs.insert(i, Output(output));
+    m_geometries.insert(i, pos);
+    updateRows(i, m_outputs.size() - 1);
+    m_names.insert(output->id(), Utils::outputName(output));
+    m_modeIndices.insert(output->id(), ModeIndex(output));
+    updateGeometry(i);
+    updateReplications();
+    m_config->updateDifferences(output, ConfigHandler::AllFields);
+
+    connect(output.get(), &Disman::Output::updated, this, [this, id = output->id()] {
+        outputUpdated(id);
+    });
     endInsertRows();
 
     // Update replications.
@@ -269,40 +284,334 @@ void OutputModel::add(const Disman::OutputPtr& output)
         if (i == j) {
             continue;
         }
-        QModelIndex index = createIndex(j, 0);
         // Calling this directly ignores possible optimization when the
         // refresh rate hasn't changed in fact. But that's ok.
-        Q_EMIT dataChanged(index, index, {ReplicationSourceModelRole, ReplicationSourceIndexRole});
+        notifyChanged(j, {ReplicationSourceModelRole, ReplicationSourceIndexRole});
     }
+
+    commitChanges();
 }
 
 void OutputModel::remove(int outputId)
 {
-    auto it = std::find_if(m_outputs.begin(), m_outputs.end(), [outputId](const Output& output) {
-        return output.ptr->id() == outputId;
-    });
-    if (it != m_outputs.end()) {
-        const int index = it - m_outputs.begin();
-        beginRemoveRows(QModelIndex(), index, index);
-        m_outputs.erase(it);
-        endRemoveRows();
+    auto const index = row(outputId);
+    if (index < 0) {
+        return;
+    }
+
+    if (outputId == m_dragId) {
+        m_dragId = 0;
+    }
+
+    beginRemoveRows(QModelIndex(), index, index);
+    disconnect(m_outputs[index].ptr.get(), nullptr, this, nullptr);
+    m_outputs.remove(index);
+    m_geometries.remove(index);
+    m_rows.remove(outputId);
+    updateRows(index, m_outputs.size() - 1);
+    m_names.remove(outputId);
+    m_modeIndices.remove(outputId);
+    if (outputId == m_bounds.rightId || outputId == m_bounds.bottomId) {
+        m_bounds.valid = false;
+    }
+    endRemoveRows();
+    updateSnapTargets();
+    updateReplications();
+    m_config->removeDifferences(outputId);
+}
+
+int OutputModel::row(int outputId) const
+{
+    return m_rows.value(outputId, -1);
+}
+
+void OutputModel::updateRows(int first, int last)
+{
+    for (int i = first; i <= last; i++) {
+        m_rows.insert(m_outputs[i].ptr->id(), i);
+    }
+}
+
+void OutputModel::refresh(const QVector<int>& outputIds)
+{
+    // The backend positions are normalized, so the view origin is offset by the smallest view
+    // position.
+    auto const delta = originDelta();
+
+    beginChanges();
+    int firstIndex = -1;
+    for (auto id : outputIds) {
+        auto const index = row(id);
+        if (index < 0) {
+            continue;
+        }
+        auto& output = m_outputs[index];
+
+        output.posReset = QPointF(-1, -1);
+        m_geometries.pos[index] = output.ptr->position() + delta;
+        updateGeometry(index);
+        m_modeIndices.insert(id, ModeIndex(output.ptr));
+
+        auto const oldSourceId = m_replicationSources.value(id);
+        auto const sourceId = replicationSourceId(output);
+        if (oldSourceId != sourceId) {
+            updateReplication(id, sourceId);
+            notifyReplicationSource(oldSourceId);
+            notifyReplicationSource(sourceId);
+        }
+
+        notifyViewChanged(index,
+                          {EnabledRole,
+                           SizeRole,
+                           PositionRole,
+                           NormalizedPositionRole,
+                           AutoResolutionRole,
+                           AutoRefreshRateRole,
+                           AutoRotateRole,
+                           AutoRotateOnlyInTabletModeRole,
+                           RotationRole,
+                           ScaleRole,
+                           ResolutionIndexRole,
+                           ResolutionsRole,
+                           RefreshRateIndexRole,
+                           RefreshRatesRole,
+                           ReplicationSourceIndexRole,
+                           AdaptiveSyncRole});
+        if (firstIndex < 0) {
+            firstIndex = index;
+        }
+    }
+
+    if (firstIndex >= 0) {
+        m_changes.position = true;
+        m_changes.size = true;
+        updateOrder(firstIndex);
+    }
+    commitChanges();
+}
+
+void OutputModel::beginChanges()
+{
+    m_changes.depth++;
+}
+
+/**
+ * @return the configuration fields that might have changed when @p roles changed.
+ */
+static ConfigHandler::Fields differenceFields(const QSet<int>& roles)
+{
+    using Field = ConfigHandler::Field;
+
+    ConfigHandler::Fields fields;
+    for (auto role : roles) {
+        switch (role) {
+        case OutputModel::EnabledRole:
+            fields |= Field::Enabled;
+            break;
+        case OutputModel::NormalizedPositionRole:
+            fields |= Field::Position;
+            break;
+        case OutputModel::ResolutionIndexRole:
+        case OutputModel::RefreshRateIndexRole:
+            fields |= Field::Mode;
+            break;
+        case OutputModel::AutoResolutionRole:
+            fields |= Field::AutoResolution | Field::Mode;
+            break;
+        case OutputModel::AutoRefreshRateRole:
+            fields |= Field::AutoRefreshRate | Field::Mode;
+            break;
+        case OutputModel::AutoRotateRole:
+            fields |= Field::AutoRotate;
+            break;
+        case OutputModel::AutoRotateOnlyInTabletModeRole:
+            fields |= Field::AutoRotateOnlyInTabletMode;
+            break;
+        case OutputModel::RotationRole:
+            fields |= Field::Rotation;
+            break;
+        case OutputModel::ScaleRole:
+            fields |= Field::Scale;
+            break;
+        case OutputModel::ReplicationSourceIndexRole:
+            // Replicas take the position of their source.
+            fields |= Field::ReplicationSource | Field::Position;
+            break;
+        case OutputModel::AdaptiveSyncRole:
+            fields |= Field::AdaptiveSync;
+            break;
+        }
+    }
+    return fields;
+}
+
+void OutputModel::commitChanges()
+{
+    assert(m_changes.depth > 0);
+    if (--m_changes.depth > 0) {
+        return;
+    }
+
+    // Reset before emitting so receivers can start their own changes from their slots.
+    auto const dirty = std::move(m_changes.roles);
+    auto const position = m_changes.position;
+    auto const size = m_changes.size;
+    auto const config = m_changes.config;
+    m_changes = Changes();
+
+    QVector<int> rows;
+    for (auto it = dirty.cbegin(); it != dirty.cend(); it++) {
+        // Outputs might have been removed in the meantime.
+        if (auto const index = row(it.key()); index >= 0) {
+            rows.append(index);
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+
+    if (config) {
+        for (auto index : rows) {
+            auto const& output = m_outputs[index].ptr;
+            if (auto const fields = differenceFields(dirty.value(output->id())); fields) {
+                m_config->updateDifferences(output, fields);
+            }
+        }
+    }
+
+    // Merge notifications for contiguous rows into a single signal with the union of their roles.
+    int first = 0;
+    while (first < rows.size()) {
+        auto roles = dirty.value(m_outputs[rows[first]].ptr->id());
+        int last = first;
+        while (last + 1 < rows.size() && rows[last + 1] == rows[last] + 1) {
+            last++;
+            roles.unite(dirty.value(m_outputs[rows[last]].ptr->id()));
+        }
+        Q_EMIT dataChanged(createIndex(rows[first], 0), createIndex(rows[last], 0), roles.values());
+        first = last + 1;
+    }
+
+    if (position) {
+        Q_EMIT positionChanged();
+    }
+    if (size) {
+        Q_EMIT sizeChanged();
+    }
+    if (config) {
+        Q_EMIT changed();
+    }
+}
+
+void OutputModel::notifyChanged(int outputIndex, const QVector<int>& roles)
+{
+    notifyViewChanged(outputIndex, roles);
+    m_changes.config = true;
+}
+
+void OutputModel::notifyViewChanged(int outputIndex, const QVector<int>& roles)
+{
+    assert(m_changes.depth > 0);
+
+    auto& dirty = m_changes.roles[m_outputs[outputIndex].ptr->id()];
+    for (auto role : roles) {
+        dirty.insert(role);
     }
 }
 
-void OutputModel::resetPosition(const Output& output)
+void OutputModel::Geometries::insert(int index, const QPointF& pos)
+{
+    this->pos.insert(index, pos);
+    backendPos.insert(index, QPointF());
+    size.insert(index, QSizeF());
+    positionable.insert(index, false);
+}
+
+void OutputModel::Geometries::remove(int index)
+{
+    pos.remove(index);
+    backendPos.remove(index);
+    size.remove(index);
+    positionable.remove(index);
+}
+
+void OutputModel::Geometries::move(int from, int to)
+{
+    pos.move(from, to);
+    backendPos.move(from, to);
+    size.move(from, to);
+    positionable.move(from, to);
+}
+
+void OutputModel::updateGeometry(int outputIndex)
+{
+    auto const& output = m_outputs[outputIndex].ptr;
+    auto const geometry = output->geometry();
+
+    m_geometries.backendPos[outputIndex] = geometry.topLeft();
+    m_geometries.size[outputIndex] = geometry.size();
+    m_geometries.positionable[outputIndex] = output->positionable();
+    updateSnapTarget(outputIndex);
+    updateBounds(outputIndex);
+}
+
+void OutputModel::setBackendPosition(int outputIndex, const QPointF& pos)
+{
+    m_outputs[outputIndex].ptr->set_position(pos);
+    m_geometries.backendPos[outputIndex] = pos;
+    updateBounds(outputIndex);
+}
+
+void OutputModel::updateBounds(int outputIndex)
 {
+    if (!m_bounds.valid) {
+        // Recomputed on the next query anyway.
+        return;
+    }
+
+    auto const id = m_outputs[outputIndex].ptr->id();
+    if (!m_geometries.positionable[outputIndex]) {
+        if (id == m_bounds.rightId || id == m_bounds.bottomId) {
+            m_bounds.valid = false;
+        }
+        return;
+    }
+
+    auto const& pos = m_geometries.backendPos[outputIndex];
+    auto const& size = m_geometries.size[outputIndex];
+    const int right = pos.x() + size.width();
+    const int bottom = pos.y() + size.height();
+
+    if (right > m_bounds.right) {
+        m_bounds.right = right;
+        m_bounds.rightId = id;
+    } else if (right < m_bounds.right && id == m_bounds.rightId) {
+        m_bounds.valid = false;
+        return;
+    }
+    if (bottom > m_bounds.bottom) {
+        m_bounds.bottom = bottom;
+        m_bounds.bottomId = id;
+    } else if (bottom < m_bounds.bottom && id == m_bounds.bottomId) {
+        m_bounds.valid = false;
+    }
+}
+
+void OutputModel::resetPosition(int outputIndex)
+{
+    auto const& output = m_outputs[outputIndex];
     if (output.posReset.x() < 0) {
         // KCM was closed in between.
-        for (const Output& out : m_outputs) {
-            if (out.ptr->id() == output.ptr->id()) {
+        auto const& backendPos = m_geometries.backendPos;
+        for (int i = 0; i < m_outputs.size(); i++) {
+            if (i == outputIndex) {
                 continue;
             }
-            if (out.ptr->geometry().right() > output.ptr->position().x()) {
-                output.ptr->set_position(out.ptr->geometry().topRight());
+            auto const right = backendPos[i].x() + m_geometries.size[i].width();
+            if (right > backendPos[outputIndex].x()) {
+                setBackendPosition(outputIndex, QPointF(right, backendPos[i].y()));
             }
         }
     } else {
-        output.ptr->set_position(/*output.ptr->position() - */ output.posReset);
+        setBackendPosition(outputIndex, output.posReset);
     }
 }
 
@@ -317,23 +626,75 @@ bool OutputModel::setEnabled(int outputIndex, bool enable)
     output.ptr->set_enabled(enable);
 
     if (enable) {
-        resetPosition(output);
+        resetPosition(outputIndex);
 
         setResolution(outputIndex, resolutionIndex(output.ptr));
         reposition();
     } else {
         output.posReset = output.ptr->position();
     }
+    updateGeometry(outputIndex);
+
+    notifyChanged(outputIndex, {EnabledRole});
+    return true;
+}
+
+bool OutputModel::setPosition(int outputIndex, QPoint pos)
+{
+    if (m_geometries.pos[outputIndex] == pos) {
+        return false;
+    }
+
+    snap(outputIndex, pos);
+    m_geometries.pos[outputIndex] = pos;
+
+    if (m_outputs[outputIndex].ptr->id() == m_dragId) {
+        // Defer everything else to the release. Others do not snap to the output in between.
+        notifyViewChanged(outputIndex, {PositionRole, NormalizedPositionRole});
+        return true;
+    }
+
+    updateSnapTarget(outputIndex);
+    notifyChanged(outputIndex, {PositionRole});
+    m_changes.position = true;
+    updatePositions(outputIndex);
+    return true;
+}
+
+bool OutputModel::setInteractiveMove(int outputIndex, bool move)
+{
+    const Output& output = m_outputs[outputIndex];
+    auto const id = output.ptr->id();
+
+    if (move) {
+        if (m_dragId == id) {
+            return false;
+        }
+        if (m_dragId) {
+            // Only one output can be dragged at a time. Release the previous one first.
+            setInteractiveMove(row(m_dragId), false);
+        }
+        m_dragId = id;
+        notifyViewChanged(outputIndex, {InteractiveMoveRole});
+        return true;
+    }
+
+    if (m_dragId != id) {
+        return false;
+    }
+    m_dragId = 0;
+    notifyViewChanged(outputIndex, {InteractiveMoveRole, NormalizedPositionRole});
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {EnabledRole});
+    updateSnapTarget(outputIndex);
+    m_changes.position = true;
+    updatePositions(outputIndex);
     return true;
 }
 
 bool OutputModel::setResolution(int outputIndex, int resIndex)
 {
     const Output& output = m_outputs[outputIndex];
-    const auto resolutionList = resolutions(output.ptr);
+    auto const& resolutionList = resolutions(output.ptr);
     if (resIndex < 0 || resIndex >= resolutionList.size()) {
         return false;
     }
@@ -354,14 +715,13 @@ bool OutputModel::setResolution(int outputIndex, int resIndex)
             assert(output.ptr->commanded_mode() == output.ptr->auto_mode());
         }
     }
-
-    QModelIndex index = createIndex(outputIndex, 0);
+    updateGeometry(outputIndex);
 
     // Calling this directly ignores possible optimization when the
     // refresh rate hasn't changed in fact. But that's ok.
-    Q_EMIT dataChanged(
-        index, index, {ResolutionIndexRole, SizeRole, RefreshRatesRole, RefreshRateIndexRole});
-    Q_EMIT sizeChanged();
+    notifyChanged(outputIndex,
+                  {ResolutionIndexRole, SizeRole, RefreshRatesRole, RefreshRateIndexRole});
+    m_changes.size = true;
     return true;
 }
 
@@ -375,8 +735,7 @@ bool OutputModel::setRefreshRate(int outputIndex, int refIndex)
     const float refreshRate = rates[refIndex];
     output.ptr->set_refresh_rate(refreshRate);
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {RefreshRateIndexRole});
+    notifyChanged(outputIndex, {RefreshRateIndexRole});
     return true;
 }
 
@@ -388,9 +747,9 @@ bool OutputModel::setAutoResolution(int outputIndex, bool value)
         return false;
     }
     output.ptr->set_auto_resolution(value);
+    updateGeometry(outputIndex);
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {AutoResolutionRole, ResolutionIndexRole, SizeRole});
+    notifyChanged(outputIndex, {AutoResolutionRole, ResolutionIndexRole, SizeRole});
     return true;
 }
 
@@ -403,8 +762,7 @@ bool OutputModel::setAutoRefreshRate(int outputIndex, bool value)
     }
     output.ptr->set_auto_refresh_rate(value);
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {AutoRefreshRateRole, RefreshRateIndexRole, RefreshRatesRole});
+    notifyChanged(outputIndex, {AutoRefreshRateRole, RefreshRateIndexRole, RefreshRatesRole});
     return true;
 }
 
@@ -417,8 +775,7 @@ bool OutputModel::setAutoRotate(int outputIndex, bool value)
     }
     output.ptr->set_auto_rotate(value);
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {AutoRotateRole});
+    notifyChanged(outputIndex, {AutoRotateRole});
     return true;
 }
 
@@ -431,8 +788,7 @@ bool OutputModel::setAutoRotateOnlyInTabletMode(int outputIndex, bool value)
     }
     output.ptr->set_auto_rotate_only_in_tablet_mode(value);
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {AutoRotateOnlyInTabletModeRole});
+    notifyChanged(outputIndex, {AutoRotateOnlyInTabletModeRole});
     return true;
 }
 
@@ -448,10 +804,10 @@ bool OutputModel::setRotation(int outputIndex, Disman::Output::Rotation rotation
         return false;
     }
     output.ptr->set_rotation(rotation);
+    updateGeometry(outputIndex);
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {RotationRole, SizeRole});
-    Q_EMIT sizeChanged();
+    notifyChanged(outputIndex, {RotationRole, SizeRole});
+    m_changes.size = true;
     return true;
 }
 
@@ -464,8 +820,7 @@ bool OutputModel::set_adaptive_sync(int outputIndex, bool value)
     }
     output.ptr->set_adaptive_sync(value);
 
-    auto index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {AdaptiveSyncRole});
+    notifyChanged(outputIndex, {AdaptiveSyncRole});
     return true;
 }
 
@@ -476,108 +831,213 @@ int OutputModel::resolutionIndex(const Disman::OutputPtr& output) const
     if (!currentResolution.isValid()) {
         return 0;
     }
-
-    const auto sizes = resolutions(output);
-
-    const auto it
-        = std::find_if(sizes.begin(), sizes.end(), [currentResolution](const QSize& size) {
-              return size == currentResolution;
-          });
-    if (it == sizes.end()) {
-        return -1;
-    }
-    return it - sizes.begin();
+    return modeIndex(output).sizeIndex(currentResolution);
 }
 
 int OutputModel::refreshRateIndex(const Disman::OutputPtr& output) const
 {
-    auto const rates = refreshRates(output);
-    auto const currentRate = output->auto_mode()->refresh();
+    auto const mode = output->auto_mode();
+    auto const& index = modeIndex(output);
 
-    auto const it = std::find(rates.cbegin(), rates.cend(), currentRate);
-    if (it == rates.cend()) {
+    auto const rateIndex = index.rateIndex(index.sizeIndex(mode->size()), mode->refresh());
+    if (rateIndex < 0) {
         return 0;
     }
-    return it - rates.cbegin();
-}
-
-static int greatestCommonDivisor(int a, int b)
-{
-    if (b == 0) {
-        return a;
-    }
-    return greatestCommonDivisor(b, a % b);
+    return rateIndex;
 }
 
 QVariantList OutputModel::resolutionsStrings(const Disman::OutputPtr& output) const
 {
-    QVariantList ret;
-    for (const QSize& size : resolutions(output)) {
-        int divisor = greatestCommonDivisor(size.width(), size.height());
+    auto const& index = modeIndex(output);
 
-        // Prefer "16:10" over "8:5"
-        if (size.height() / divisor == 5) {
-            divisor /= 2;
-        }
-        // Prefer "21:9" over "64:27"
-        else if (size.height() / divisor == 27) {
-            divisor *= 3;
-        }
+    if (index.sizeLabels.size() == index.sizes.size()) {
+        return index.sizeLabels;
+    }
+
+    for (int i = 0; i < index.sizes.size(); i++) {
+        auto const& size = index.sizes[i];
+        auto const& ratio = index.aspectRatios[i];
 
         const QString text = i18nc("Width x height (aspect ratio)",
                                    "%1x%2 (%3:%4)",
                                    // Explicitly not have it add thousand-separators.
                                    QString::number(size.width()),
                                    QString::number(size.height()),
-                                   size.width() / divisor,
-                                   size.height() / divisor);
-
-        ret << text;
+                                   ratio.width(),
+                                   ratio.height());
+        index.sizeLabels << text;
     }
-    return ret;
+    return index.sizeLabels;
 }
 
-QVector<QSize> OutputModel::resolutions(const Disman::OutputPtr& output) const
+QVariantList OutputModel::refreshRatesStrings(const Disman::OutputPtr& output) const
 {
-    QVector<QSize> hits;
+    auto const& index = modeIndex(output);
 
-    for (auto const& [key, mode] : output->modes()) {
-        const QSize size = mode->size();
-        if (!hits.contains(size)) {
-            hits << size;
-        }
+    auto const sizeIndex = index.sizeIndex(output->auto_mode()->size());
+    if (sizeIndex < 0) {
+        return {};
     }
-    std::sort(hits.begin(), hits.end(), [](const QSize& a, const QSize& b) {
-        if (a.width() > b.width()) {
-            return true;
-        }
-        if (a.width() == b.width() && a.height() > b.height()) {
-            return true;
+
+    // We just show rounded values when not manual selecting a rate.
+    auto const rounded = output->auto_refresh_rate();
+    auto& labels = rounded ? index.roundedRateLabels[sizeIndex] : index.exactRateLabels[sizeIndex];
+
+    if (!labels.isEmpty()) {
+        return labels;
+    }
+
+    for (auto rate : index.rates[sizeIndex]) {
+        if (rounded) {
+            labels << i18nc("Approximate refresh rate in Hz (rounded to integer)",
+                            "≈ %1 Hz",
+                            static_cast<int>(rate / 1000. + 0.5));
+        } else {
+            labels << i18nc("Refresh rate in Hz (rounded to 3 digits)",
+                            "%1 Hz",
+                            static_cast<double>(rate / 1000.));
         }
-        return false;
-    });
-    return hits;
+    }
+    return labels;
+}
+
+const QVector<QSize>& OutputModel::resolutions(const Disman::OutputPtr& output) const
+{
+    return modeIndex(output).sizes;
 }
 
 QVector<int> OutputModel::refreshRates(const Disman::OutputPtr& output) const
 {
-    QVector<int> hits;
+    auto const& index = modeIndex(output);
+
+    auto const sizeIndex = index.sizeIndex(output->auto_mode()->size());
+    if (sizeIndex < 0) {
+        return {};
+    }
+    return index.rates[sizeIndex];
+}
+
+static bool isLargerResolution(const QSize& a, const QSize& b)
+{
+    if (a.width() > b.width()) {
+        return true;
+    }
+    if (a.width() == b.width() && a.height() > b.height()) {
+        return true;
+    }
+    return false;
+}
+
+static QSize aspectRatio(const QSize& size)
+{
+    int divisor = std::gcd(size.width(), size.height());
+    if (divisor == 0) {
+        return QSize();
+    }
 
-    auto const resolution = output->auto_mode()->size();
+    // Prefer "16:10" over "8:5"
+    if (size.height() / divisor == 5) {
+        divisor /= 2;
+    }
+    // Prefer "21:9" over "64:27"
+    else if (size.height() / divisor == 27) {
+        divisor *= 3;
+    }
+    return QSize(size.width() / divisor, size.height() / divisor);
+}
 
+OutputModel::ModeIndex::ModeIndex(const Disman::OutputPtr& output)
+{
+    QVector<QPair<QSize, int>> modes;
     for (auto const& [key, mode] : output->modes()) {
-        if (mode->size() != resolution) {
-            continue;
+        modes.append({mode->size(), mode->refresh()});
+    }
+
+    std::sort(modes.begin(), modes.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) {
+            return isLargerResolution(a.first, b.first);
         }
-        auto const rate = mode->refresh();
-        if (std::find(hits.cbegin(), hits.cend(), rate) != hits.cend()) {
-            continue;
+        return a.second > b.second;
+    });
+
+    for (auto const& [size, rate] : modes) {
+        if (sizes.isEmpty() || sizes.last() != size) {
+            sizes.append(size);
+            rates.append(QVector<int>());
+            aspectRatios.append(aspectRatio(size));
+        }
+        auto& sizeRates = rates.last();
+        if (sizeRates.isEmpty() || sizeRates.last() != rate) {
+            sizeRates.append(rate);
         }
-        hits << rate;
     }
-    std::sort(hits.begin(), hits.end());
-    std::reverse(hits.begin(), hits.end());
-    return hits;
+
+    roundedRateLabels.resize(sizes.size());
+    exactRateLabels.resize(sizes.size());
+}
+
+int OutputModel::ModeIndex::sizeIndex(const QSize& size) const
+{
+    auto const it = std::lower_bound(sizes.cbegin(), sizes.cend(), size, isLargerResolution);
+    if (it == sizes.cend() || *it != size) {
+        return -1;
+    }
+    return it - sizes.cbegin();
+}
+
+int OutputModel::ModeIndex::rateIndex(int sizeIndex, int rate) const
+{
+    if (sizeIndex < 0 || sizeIndex >= rates.size()) {
+        return -1;
+    }
+    auto const& sizeRates = rates[sizeIndex];
+
+    auto const it = std::lower_bound(sizeRates.cbegin(), sizeRates.cend(), rate, std::greater<>());
+    if (it == sizeRates.cend() || *it != rate) {
+        return -1;
+    }
+    return it - sizeRates.cbegin();
+}
+
+const OutputModel::ModeIndex& OutputModel::modeIndex(const Disman::OutputPtr& output) const
+{
+    auto const it = m_modeIndices.constFind(output->id());
+
+    // Indices are created when the output is added and only dropped on its removal.
+    assert(it != m_modeIndices.cend());
+    return *it;
+}
+
+void OutputModel::outputUpdated(int outputId)
+{
+    auto const index = row(outputId);
+    if (index < 0) {
+        return;
+    }
+    auto const& output = m_outputs[index];
+
+    m_modeIndices.insert(outputId, ModeIndex(output.ptr));
+    updateGeometry(index);
+    m_config->updateDifferences(output.ptr, ConfigHandler::AllFields);
+
+    beginChanges();
+    notifyChanged(index,
+                  {ResolutionIndexRole,
+                   ResolutionsRole,
+                   RefreshRateIndexRole,
+                   RefreshRatesRole,
+                   SizeRole,
+                   NormalizedPositionRole});
+
+    auto const oldSourceId = m_replicationSources.value(outputId);
+    auto const sourceId = replicationSourceId(output);
+    if (oldSourceId != sourceId) {
+        updateReplication(outputId, sourceId);
+        notifyChanged(index, {ReplicationSourceIndexRole});
+        notifyReplicationSource(oldSourceId);
+        notifyReplicationSource(sourceId);
+    }
+    commitChanges();
 }
 
 int OutputModel::replicationSourceId(const Output& output) const
@@ -587,25 +1047,73 @@ int OutputModel::replicationSourceId(const Output& output) const
 
 QStringList OutputModel::replicationSourceModel(const Disman::OutputPtr& output) const
 {
-    QStringList ret = {i18nc("Displayed when no replication source is selected.", "None")};
+    auto const id = output->id();
+    if (auto const it = m_replicationSourceModels.constFind(id);
+        it != m_replicationSourceModels.cend()) {
+        return *it;
+    }
 
-    for (const auto& out : m_outputs) {
-        if (out.ptr->id() != output->id()) {
-            const int outSourceId = replicationSourceId(out);
-            if (outSourceId == output->id()) {
-                // 'output' is already source for replication, can't be replica itself
-                return {i18n("Replicated by other display")};
-            }
-            if (outSourceId) {
-                // This 'out' is a replica. Can't be a replication source.
+    QStringList ret;
+    if (m_replicas.contains(id)) {
+        // 'output' is already source for replication, can't be replica itself
+        ret = QStringList{i18n("Replicated by other display")};
+    } else {
+        ret = QStringList{i18nc("Displayed when no replication source is selected.", "None")};
+        for (const auto& out : m_outputs) {
+            if (out.ptr->id() == id || replicationSourceId(out)) {
+                // Skip 'output' itself and replicas. These can't be a replication source.
                 continue;
             }
-            ret.append(Utils::outputName(out.ptr));
+            ret.append(m_names.value(out.ptr->id()));
         }
     }
+
+    m_replicationSourceModels.insert(id, ret);
     return ret;
 }
 
+void OutputModel::updateReplication(int outputId, int sourceId)
+{
+    auto const oldSourceId = m_replicationSources.value(outputId);
+    if (oldSourceId == sourceId) {
+        return;
+    }
+
+    if (oldSourceId) {
+        auto it = m_replicas.find(oldSourceId);
+        it->removeOne(outputId);
+        if (it->isEmpty()) {
+            m_replicas.erase(it);
+        }
+        m_replicationSources.remove(outputId);
+    }
+    if (sourceId) {
+        m_replicas[sourceId].append(outputId);
+        m_replicationSources.insert(outputId, sourceId);
+    }
+
+    // The lists depend on which outputs are replicas.
+    m_replicationSourceModels.clear();
+}
+
+void OutputModel::updateReplications()
+{
+    m_replicas.clear();
+    m_replicationSources.clear();
+    m_replicationSourceModels.clear();
+
+    for (auto const& output : m_outputs) {
+        updateReplication(output.ptr->id(), replicationSourceId(output));
+    }
+}
+
+void OutputModel::notifyReplicationSource(int sourceId)
+{
+    if (auto const index = row(sourceId); index >= 0) {
+        notifyChanged(index, {ReplicationSourceModelRole, ReplicasModelRole});
+    }
+}
+
 bool OutputModel::setReplicationSourceIndex(int outputIndex, int sourceIndex)
 {
     if (outputIndex <= sourceIndex) {
@@ -624,7 +1132,7 @@ bool OutputModel::setReplicationSourceIndex(int outputIndex, int sourceIndex)
             return false;
         }
         output.ptr->set_replication_source(0);
-        resetPosition(output);
+        resetPosition(outputIndex);
     } else {
         const auto source = m_outputs[sourceIndex].ptr;
         if (oldSourceId == source->id()) {
@@ -633,27 +1141,17 @@ bool OutputModel::setReplicationSourceIndex(int outputIndex, int sourceIndex)
         }
         output.ptr->set_replication_source(source->id());
         output.posReset = output.ptr->position();
-        output.ptr->set_position(source->position());
+        setBackendPosition(outputIndex, m_geometries.backendPos[sourceIndex]);
     }
 
+    updateReplication(output.ptr->id(), replicationSourceId(output));
+    updateGeometry(outputIndex);
     reposition();
 
-    QModelIndex index = createIndex(outputIndex, 0);
-    Q_EMIT dataChanged(index, index, {ReplicationSourceIndexRole});
-
-    if (oldSourceId != 0) {
-        auto it
-            = std::find_if(m_outputs.begin(), m_outputs.end(), [oldSourceId](const Output& out) {
-                  return out.ptr->id() == oldSourceId;
-              });
-        if (it != m_outputs.end()) {
-            QModelIndex index = createIndex(it - m_outputs.begin(), 0);
-            Q_EMIT dataChanged(index, index, {ReplicationSourceModelRole, ReplicasModelRole});
-        }
-    }
+    notifyChanged(outputIndex, {ReplicationSourceIndexRole});
+    notifyReplicationSource(oldSourceId);
     if (sourceIndex >= 0) {
-        QModelIndex index = createIndex(sourceIndex, 0);
-        Q_EMIT dataChanged(index, index, {ReplicationSourceModelRole, ReplicasModelRole});
+        notifyChanged(sourceIndex, {ReplicationSourceModelRole, ReplicasModelRole});
     }
     return true;
 }
@@ -664,65 +1162,66 @@ int OutputModel::replicationSourceIndex(int outputIndex) const
     if (!sourceId) {
         return 0;
     }
-    for (int i = 0; i < m_outputs.size(); i++) {
-        const Output& output = m_outputs[i];
-        if (output.ptr->id() == sourceId) {
-            return i + (outputIndex > i ? 1 : 0);
-        }
+    auto const sourceIndex = row(sourceId);
+    if (sourceIndex < 0) {
+        return 0;
     }
-    return 0;
+    return sourceIndex + (outputIndex > sourceIndex ? 1 : 0);
 }
 
 QVariantList OutputModel::replicasModel(const Disman::OutputPtr& output) const
 {
-    QVariantList ret;
-    for (int i = 0; i < m_outputs.size(); i++) {
-        const Output& out = m_outputs[i];
-        if (out.ptr->id() != output->id()) {
-            if (replicationSourceId(out) == output->id()) {
-                ret << i;
-            }
+    QVector<int> rows;
+    for (auto replicaId : m_replicas.value(output->id())) {
+        if (auto const index = row(replicaId); index >= 0) {
+            rows.append(index);
         }
     }
-    return ret;
-}
+    std::sort(rows.begin(), rows.end());
 
-void OutputModel::roleChanged(int outputId, OutputRoles role)
-{
-    for (int i = 0; i < m_outputs.size(); i++) {
-        Output& output = m_outputs[i];
-        if (output.ptr->id() == outputId) {
-            QModelIndex index = createIndex(i, 0);
-            Q_EMIT dataChanged(index, index, {role});
-            return;
-        }
+    QVariantList ret;
+    for (auto index : rows) {
+        ret << index;
     }
+    return ret;
 }
 
-bool OutputModel::positionable(const Output& output) const
+void OutputModel::primaryOutputChanged(const Disman::OutputPtr& output)
 {
-    return output.ptr->positionable();
+    auto const oldPrimaryIndex = row(m_primaryId);
+    m_primaryId = output ? output->id() : 0;
+
+    beginChanges();
+    if (oldPrimaryIndex >= 0) {
+        notifyChanged(oldPrimaryIndex, {PrimaryRole});
+    }
+    if (auto const primaryIndex = row(m_primaryId); primaryIndex >= 0) {
+        notifyChanged(primaryIndex, {PrimaryRole});
+    }
+    commitChanges();
 }
 
 void OutputModel::reposition()
 {
+    auto const& positionable = m_geometries.positionable;
+    auto const& backendPos = m_geometries.backendPos;
     int x = 0;
     int y = 0;
 
     // Find first valid output.
-    for (const auto& out : m_outputs) {
-        if (positionable(out)) {
-            x = out.ptr->position().x();
-            y = out.ptr->position().y();
+    for (int i = 0; i < m_outputs.size(); i++) {
+        if (positionable[i]) {
+            x = backendPos[i].x();
+            y = backendPos[i].y();
             break;
         }
     }
 
     for (int i = 0; i < m_outputs.size(); i++) {
-        if (!positionable(m_outputs[i])) {
+        if (!positionable[i]) {
             continue;
         }
-        auto const& cmp = m_outputs[i].ptr->position();
+        auto const& cmp = backendPos[i];
 
         if (cmp.x() < x) {
             x = cmp.x();
@@ -737,33 +1236,33 @@ void OutputModel::reposition()
     }
 
     for (int i = 0; i < m_outputs.size(); i++) {
-        auto& out = m_outputs[i];
-        out.ptr->set_position(out.ptr->position() - QPoint(x, y));
-        QModelIndex index = createIndex(i, 0);
-        Q_EMIT dataChanged(index, index, {NormalizedPositionRole});
+        setBackendPosition(i, backendPos[i] - QPoint(x, y));
+        notifyChanged(i, {NormalizedPositionRole});
     }
     m_config->normalizeScreen();
 }
 
 QPoint OutputModel::originDelta() const
 {
+    auto const& positionable = m_geometries.positionable;
+    auto const& pos = m_geometries.pos;
     int x = 0;
     int y = 0;
 
     // Find first valid output.
-    for (const auto& out : m_outputs) {
-        if (positionable(out)) {
-            x = out.pos.x();
-            y = out.pos.y();
+    for (int i = 0; i < m_outputs.size(); i++) {
+        if (positionable[i]) {
+            x = pos[i].x();
+            y = pos[i].y();
             break;
         }
     }
 
     for (int i = 1; i < m_outputs.size(); i++) {
-        if (!positionable(m_outputs[i])) {
+        if (!positionable[i]) {
             continue;
         }
-        auto const& cmp = m_outputs[i].pos;
+        auto const& cmp = pos[i];
 
         if (cmp.x() < x) {
             x = cmp.x();
@@ -775,77 +1274,157 @@ QPoint OutputModel::originDelta() const
     return QPoint(x, y);
 }
 
-void OutputModel::updatePositions()
+void OutputModel::updatePositions(int outputIndex)
 {
     const QPoint delta = originDelta();
     for (int i = 0; i < m_outputs.size(); i++) {
-        const auto& out = m_outputs[i];
-        if (!positionable(out)) {
+        if (!m_geometries.positionable[i]) {
             continue;
         }
-        auto const set = out.pos - delta;
-        if (out.ptr->position() != set) {
-            out.ptr->set_position(set);
-            QModelIndex index = createIndex(i, 0);
-            Q_EMIT dataChanged(index, index, {NormalizedPositionRole});
+        auto const set = m_geometries.pos[i] - delta;
+        if (m_geometries.backendPos[i] != set) {
+            setBackendPosition(i, set);
+            notifyChanged(i, {NormalizedPositionRole});
         }
     }
-    updateOrder();
+    updateOrder(outputIndex);
 }
 
-void OutputModel::updateOrder()
+static bool isOrderedBefore(const QPointF& a, const QPointF& b)
 {
-    auto order = m_outputs;
-    std::sort(order.begin(), order.end(), [](const Output& a, const Output& b) {
-        const int xDiff = b.ptr->position().x() - a.ptr->position().x();
-        const int yDiff = b.ptr->position().y() - a.ptr->position().y();
-        if (xDiff > 0) {
-            return true;
+    const int xDiff = b.x() - a.x();
+    const int yDiff = b.y() - a.y();
+    if (xDiff > 0) {
+        return true;
+    }
+    if (xDiff == 0 && yDiff > 0) {
+        return true;
+    }
+    return false;
+}
+
+void OutputModel::updateOrder(int outputIndex)
+{
+    // Rows are ordered by backend position, which is indexed like the rows.
+    auto const& pos = m_geometries.backendPos;
+    auto const before = [&pos](int a, int b) { return isOrderedBefore(pos[a], pos[b]); };
+
+    // All other outputs were shifted by the same delta and keep their relative order. Then only
+    // the moved output might need a new row.
+    bool othersOrdered = true;
+    int previous = -1;
+    for (int i = 0; i < m_outputs.size(); i++) {
+        if (i == outputIndex) {
+            continue;
         }
-        if (xDiff == 0 && yDiff > 0) {
-            return true;
+        if (previous >= 0 && before(i, previous)) {
+            othersOrdered = false;
+            break;
         }
-        return false;
-    });
+        previous = i;
+    }
 
-    for (int i = 0; i < order.size(); i++) {
-        for (int j = 0; j < m_outputs.size(); j++) {
-            if (order[i].ptr->id() != m_outputs[j].ptr->id()) {
-                continue;
-            }
-            if (i != j) {
-                beginMoveRows(QModelIndex(), j, j, QModelIndex(), i);
-                m_outputs.remove(j);
-                m_outputs.insert(i, order[i]);
-                endMoveRows();
+    if (!othersOrdered) {
+        // Outputs that are not positionable keep their positions. These might be out of order
+        // now. Sort all by insertion, which moves every output at most once.
+        for (int i = 1; i < m_outputs.size(); i++) {
+            auto const begin = pos.cbegin();
+            auto const it = std::upper_bound(begin, begin + i, pos[i], isOrderedBefore);
+            moveOutput(i, it - begin);
+        }
+        return;
+    }
+
+    if ((outputIndex == 0 || !before(outputIndex, outputIndex - 1))
+        && (outputIndex == m_outputs.size() - 1 || !before(outputIndex + 1, outputIndex))) {
+        // Still in order.
+        return;
+    }
+
+    // Search the slot in the ordered rows before and after the moved output separately.
+    auto const moved = pos[outputIndex];
+    auto const begin = pos.cbegin();
+    int target;
+    if (outputIndex > 0 && before(outputIndex, outputIndex - 1)) {
+        target = std::upper_bound(begin, begin + outputIndex, moved, isOrderedBefore) - begin;
+    } else {
+        target = std::lower_bound(begin + outputIndex + 1, pos.cend(), moved, isOrderedBefore)
+            - begin;
+        target--;
+    }
+    moveOutput(outputIndex, target);
+}
+
+void OutputModel::moveOutput(int from, int to)
+{
+    if (from == to) {
+        return;
+    }
+
+    // The destination argument is the row index before the move, that is behind the target row
+    // when moving down.
+    auto const first = std::min(from, to);
+    auto const last = std::max(from, to);
+
+    beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to);
+    m_outputs.move(from, to);
+    m_geometries.move(from, to);
+    updateRows(first, last);
+    endMoveRows();
+
+    // Sources are listed in the order of rows. Replicas are not listed, so moving one changes no
+    // list. Otherwise every list but the one of the moved output itself changes order. Outputs
+    // that are sources have a fixed list.
+    m_replicationSourceModels.clear();
+    if (!replicationSourceId(m_outputs[to])) {
+        for (int i = 0; i < m_outputs.size(); i++) {
+            if (i != to && !m_replicas.contains(m_outputs[i].ptr->id())) {
+                notifyChanged(i, {ReplicationSourceModelRole});
             }
-            break;
         }
     }
 
-    // TODO: Could this be optimized by only outputs updating where replica indices changed?
+    // Replica indices only change for outputs whose row or whose source's row has shifted.
+    auto const shifted = [first, last](int index) { return index >= first && index <= last; };
+
     for (int i = 0; i < m_outputs.size(); i++) {
-        QModelIndex index = createIndex(i, 0);
-        Q_EMIT dataChanged(index, index, {ReplicasModelRole});
+        auto const sourceId = replicationSourceId(m_outputs[i]);
+        if (!sourceId) {
+            continue;
+        }
+        auto const sourceIndex = row(sourceId);
+        if (sourceIndex < 0) {
+            continue;
+        }
+        if (shifted(i) || shifted(sourceIndex)) {
+            notifyChanged(i, {ReplicationSourceIndexRole});
+            notifyChanged(sourceIndex, {ReplicasModelRole});
+        }
     }
 }
 
 bool OutputModel::normalizePositions()
 {
+    beginChanges();
+
     bool changed = false;
     for (int i = 0; i < m_outputs.size(); i++) {
-        auto& output = m_outputs[i];
-        if (output.pos == output.ptr->position()) {
+        auto& pos = m_geometries.pos[i];
+        if (pos == m_geometries.backendPos[i]) {
             continue;
         }
-        if (!positionable(output)) {
+        if (!m_geometries.positionable[i] || m_outputs[i].ptr->id() == m_dragId) {
             continue;
         }
         changed = true;
-        auto index = createIndex(i, 0);
-        output.pos = output.ptr->position();
-        Q_EMIT dataChanged(index, index, {PositionRole});
+        pos = m_geometries.backendPos[i];
+        notifyViewChanged(i, {PositionRole});
     }
+    if (changed) {
+        updateSnapTargets();
+    }
+
+    commitChanges();
     return changed;
 }
 
@@ -855,6 +1434,38 @@ bool OutputModel::positionsNormalized() const
     return originDelta().manhattanLength() < 5;
 }
 
+QSize OutputModel::screenSize() const
+{
+    if (!m_bounds.valid) {
+        m_bounds = Bounds();
+        m_bounds.valid = true;
+
+        for (int i = 0; i < m_outputs.size(); i++) {
+            if (!m_geometries.positionable[i]) {
+                continue;
+            }
+            auto const id = m_outputs[i].ptr->id();
+            const int outputRight = m_geometries.backendPos[i].x() + m_geometries.size[i].width();
+            const int outputBottom
+                = m_geometries.backendPos[i].y() + m_geometries.size[i].height();
+
+            if (outputRight > m_bounds.right) {
+                m_bounds.right = outputRight;
+                m_bounds.rightId = id;
+            }
+            if (outputBottom > m_bounds.bottom) {
+                m_bounds.bottom = outputBottom;
+                m_bounds.bottomId = id;
+            }
+        }
+    }
+
+    if (m_bounds.right > 0 && m_bounds.bottom > 0) {
+        return QSize(m_bounds.right, m_bounds.bottom);
+    }
+    return QSize();
+}
+
 const int s_snapArea = 80;
 
 bool isVerticalClose(const QRectF& rect1, const QRectF& rect2)
@@ -954,35 +1565,129 @@ bool snapVertical(const QRectF& target, const QSizeF& size, QPoint& dest)
     return false;
 }
 
-void OutputModel::snap(const Output& output, QPoint& dest)
+/**
+ * Order of outputs in rows, in which they are snapped to.
+ */
+static bool isBeforeInRows(const QRectF& a, const QRectF& b)
 {
-    auto const size = output.ptr->geometry().size();
-    for (const Output& out : m_outputs) {
-        if (out.ptr->id() == output.ptr->id()) {
-            // Can not snap to itself.
-            continue;
-        }
-        if (!positionable(out)) {
-            continue;
+    const int xDiff = b.x() - a.x();
+    const int yDiff = b.y() - a.y();
+    return xDiff > 0 || (xDiff == 0 && yDiff > 0);
+}
+
+void OutputModel::snap(int outputIndex, QPoint& dest)
+{
+    auto const id = m_outputs[outputIndex].ptr->id();
+    auto const size = m_geometries.size[outputIndex];
+
+    auto candidates = snapCandidates(QRectF(dest, size));
+    for (int i = 0; i < candidates.size(); i++) {
+        auto const target = candidates.at(i);
+        auto const y = dest.y();
+        snapTo(id, target, size, dest);
+
+        if (dest.y() != y) {
+            // Other targets might have come into reach or gone out of it. Continue with the
+            // ones that follow in the order of rows like when going through all outputs.
+            candidates = snapCandidates(QRectF(dest, size));
+            auto const next = std::upper_bound(
+                candidates.cbegin(), candidates.cend(), target, [](auto const& a, auto const& b) {
+                    return isBeforeInRows(a.rect, b.rect);
+                });
+            i = next - candidates.cbegin() - 1;
         }
+    }
+}
 
-        auto const target = QRectF(out.pos, out.ptr->geometry().size());
+void OutputModel::snapTo(int id, const SnapTarget& target, const QSizeF& size, QPoint& dest)
+{
+    if (target.id == id) {
+        // Can not snap to itself.
+        return;
+    }
+    if (!isVerticalClose(target.rect, QRectF(dest, size))) {
+        return;
+    }
 
-        if (!isVerticalClose(target, QRectF(dest, size))) {
-            continue;
-        }
+    // try snap left to right first
+    if (snapToRight(target.rect, size, dest)) {
+        snapVertical(target.rect, size, dest);
+        return;
+    }
+    if (snapToLeft(target.rect, size, dest)) {
+        snapVertical(target.rect, size, dest);
+        return;
+    }
+    snapVertical(target.rect, size, dest);
+}
 
-        // try snap left to right first
-        if (snapToRight(target, size, dest)) {
-            snapVertical(target, size, dest);
-            continue;
-        }
-        if (snapToLeft(target, size, dest)) {
-            snapVertical(target, size, dest);
-            continue;
+QVector<OutputModel::SnapTarget> OutputModel::snapCandidates(const QRectF& rect) const
+{
+    // Only targets in the vertical snap zone of the rect are found. Callers query again when
+    // snapping moves the rect vertically.
+    auto const margin = s_snapArea;
+    auto const isAbove = [](qreal top, auto const& target) { return top < target.rect.top(); };
+    auto const isBelow = [](auto const& target, qreal top) { return target.rect.top() < top; };
+
+    // A target is close up to and including a distance of the margin, like in snapTo.
+    auto const begin = std::lower_bound(m_snapTargets.cbegin(),
+                                        m_snapTargets.cend(),
+                                        rect.top() - margin - m_snapTargetsMaxHeight,
+                                        isBelow);
+    auto const end = std::upper_bound(begin, m_snapTargets.cend(), rect.bottom() + margin, isAbove);
+
+    QVector<SnapTarget> candidates;
+    for (auto it = begin; it != end; it++) {
+        if (it->rect.bottom() >= rect.top() - margin) {
+            candidates.append(*it);
         }
-        if (snapVertical(target, size, dest)) {
-            continue;
+    }
+
+    // Snap to the targets in the order of the rows like when going through all outputs.
+    std::sort(candidates.begin(), candidates.end(), [](auto const& a, auto const& b) {
+        return isBeforeInRows(a.rect, b.rect);
+    });
+    return candidates;
+}
+
+void OutputModel::updateSnapTarget(int outputIndex)
+{
+    auto const id = m_outputs[outputIndex].ptr->id();
+
+    auto it = std::find_if(m_snapTargets.begin(), m_snapTargets.end(), [id](auto const& target) {
+        return target.id == id;
+    });
+    if (it != m_snapTargets.end()) {
+        auto const height = it->rect.height();
+        m_snapTargets.erase(it);
+        if (height >= m_snapTargetsMaxHeight) {
+            m_snapTargetsMaxHeight = 0;
+            for (auto const& target : m_snapTargets) {
+                m_snapTargetsMaxHeight = std::max(m_snapTargetsMaxHeight, target.rect.height());
+            }
         }
     }
+
+    if (!m_geometries.positionable[outputIndex]) {
+        return;
+    }
+
+    SnapTarget const target{
+        id, QRectF(m_geometries.pos[outputIndex], m_geometries.size[outputIndex])};
+    auto const pos = std::upper_bound(
+        m_snapTargets.begin(), m_snapTargets.end(), target, [](auto const& a, auto const& b) {
+            return a.rect.top() < b.rect.top();
+        });
+    m_snapTargets.insert(pos, target);
+    m_snapTargetsMaxHeight = std::max(m_snapTargetsMaxHeight, target.rect.height());
+}
+
+void OutputModel::updateSnapTargets()
+{
+    m_snapTargets.clear();
+    m_snapTargetsMaxHeight = 0;
+
+    for (int i = 0; i < m_outputs.size(); i++) {
+        updateSnapTarget(i);
+    }
 }
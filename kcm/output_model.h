@@ -20,13 +20,20 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <disman/output.h>
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <QPoint>
+#include <QRectF>
+#include <QSet>
+#include <QSize>
+#include <QVector>
+#include <qqmlintegration.h>
 
 class ConfigHandler;
 
 class OutputModel : public QAbstractListModel
 {
     Q_OBJECT
+    QML_ANONYMOUS
 public:
     enum OutputRoles {
         EnabledRole = Qt::UserRole + 1,
@@ -52,6 +59,11 @@ public:
         ReplicasModelRole,
         AdaptiveSyncToggleSupportRole,
         AdaptiveSyncRole,
+        /**
+         * Set while the output is dragged in the view. Positions set in between only move the
+         * output in the view. The backend position and the order of rows follow on release.
+         */
+        InteractiveMoveRole,
     };
 
     explicit OutputModel(ConfigHandler* configHandler);
@@ -64,6 +76,13 @@ public:
     void add(const Disman::OutputPtr& output);
     void remove(int outputId);
 
+    /**
+     * Updates the outputs with @p outputIds after their Disman outputs have been changed from
+     * outside, for example by reverting to an earlier state or by merging changes of the backend
+     * including new mode lists. The view keeps its origin.
+     */
+    void refresh(const QVector<int>& outputIds);
+
     /**
      * Resets the origin for calculation of positions to the most northwest display corner
      * while keeping the normalized positions untouched.
@@ -73,6 +92,21 @@ public:
     bool normalizePositions();
     bool positionsNormalized() const;
 
+    /**
+     * @return size of the area spanned by all positionable outputs from the backend origin or an
+     * invalid size if there are none.
+     */
+    QSize screenSize() const;
+
+    /**
+     * Starts collecting change notifications instead of sending them one by one. Calls can be
+     * nested. When the outermost transaction is committed the collected roles are sent with one
+     * dataChanged signal per range of contiguous rows followed by single positionChanged and
+     * sizeChanged signals as needed and a changed signal if the configuration was altered.
+     */
+    void beginChanges();
+    void commitChanges();
+
 Q_SIGNALS:
     void positionChanged();
     void sizeChanged();
@@ -82,51 +116,162 @@ protected:
     QHash<int, QByteArray> roleNames() const override;
 
 private:
+    friend class TestOutputModel;
+
     struct Output {
         Output()
         {
         }
         Output(const Output& output)
             : ptr(output.ptr)
-            , pos(output.pos)
         {
         }
         Output(Output&&) noexcept = default;
-        Output(Disman::OutputPtr _ptr, const QPointF& _pos)
+        explicit Output(Disman::OutputPtr _ptr)
             : ptr(_ptr)
-            , pos(_pos)
         {
         }
         Output& operator=(const Output& output)
         {
             ptr = output.ptr;
-            pos = output.pos;
             posReset = QPoint(-1, -1);
             return *this;
         }
         Output& operator=(Output&&) noexcept = default;
 
         Disman::OutputPtr ptr;
-        QPointF pos;
         QPointF posReset = QPointF(-1, -1);
     };
 
-    void roleChanged(int outputId, OutputRoles role);
+    /**
+     * The numbers layout calculations run on, indexed by row. Loops over all outputs then walk
+     * flat arrays instead of calling into the Disman outputs, which for example compute their
+     * geometry from mode, rotation and scale on every call.
+     */
+    struct Geometries {
+        void insert(int index, const QPointF& pos);
+        void remove(int index);
+        void move(int from, int to);
+
+        /** Position in the view, see PositionRole. */
+        QVector<QPointF> pos;
+        /** Mirrors the position of the Disman output, see NormalizedPositionRole. */
+        QVector<QPointF> backendPos;
+        /** Mirrors the logical size of the Disman output. */
+        QVector<QSizeF> size;
+        /** Mirrors whether the Disman output is positionable. */
+        QVector<bool> positionable;
+    };
+
+    /**
+     * Resolutions and refresh rates offered by an output in the order they are presented in the
+     * view. Looking up the list for a role is then a plain access instead of a walk over all modes.
+     */
+    struct ModeIndex {
+        ModeIndex() = default;
+        explicit ModeIndex(const Disman::OutputPtr& output);
+
+        /**
+         * @return index of @p size in sizes or -1 if the output does not support it.
+         */
+        int sizeIndex(const QSize& size) const;
+        /**
+         * @return index of @p rate in the rates of the resolution at @p sizeIndex or -1.
+         */
+        int rateIndex(int sizeIndex, int rate) const;
+
+        /** Unique resolutions, ordered from largest to smallest. */
+        QVector<QSize> sizes;
+        /** Unique refresh rates per resolution from highest to lowest, indexed like sizes. */
+        QVector<QVector<int>> rates;
+        /** Reduced aspect ratio of each resolution, indexed like sizes. */
+        QVector<QSize> aspectRatios;
+
+        /**
+         * Localized labels handed to the view. They are created on first request and live as
+         * long as the index, that is until the output's modes change.
+         */
+        mutable QVariantList sizeLabels;
+        mutable QVector<QVariantList> roundedRateLabels;
+        mutable QVector<QVariantList> exactRateLabels;
+    };
+
+    struct Changes {
+        int depth = 0;
+        /** Changed roles per output id. Rows are only resolved on commit as they might move. */
+        QHash<int, QSet<int>> roles;
+        bool position = false;
+        bool size = false;
+        /** Whether the configuration changed and not only its presentation in the view. */
+        bool config = false;
+    };
+
+    bool setOutputData(int outputIndex, const QVariant& value, int role);
+    void notifyChanged(int outputIndex, const QVector<int>& roles);
+    void notifyViewChanged(int outputIndex, const QVector<int>& roles);
+
+    /**
+     * @return the row of the output with @p outputId or -1 if it is not in the model.
+     */
+    int row(int outputId) const;
+    void updateRows(int first, int last);
+
+    void primaryOutputChanged(const Disman::OutputPtr& output);
+    void outputUpdated(int outputId);
+    const ModeIndex& modeIndex(const Disman::OutputPtr& output) const;
+
+    /**
+     * Refreshes the cached geometry of the output at @p outputIndex from its Disman output. Must
+     * be called whenever its position, size or positionable state has changed.
+     */
+    void updateGeometry(int outputIndex);
+    void setBackendPosition(int outputIndex, const QPointF& pos);
+
+    /**
+     * Extends the screen bounds by the output at @p outputIndex or invalidates them when it
+     * defined an extreme and moved inwards.
+     */
+    void updateBounds(int outputIndex);
 
-    void resetPosition(const Output& output);
+    void resetPosition(int outputIndex);
     void reposition();
-    void updatePositions();
-    void updateOrder();
+    void updatePositions(int outputIndex);
+    /**
+     * Restores the order of rows by position after the output at @p outputIndex has been moved.
+     */
+    void updateOrder(int outputIndex);
+    void moveOutput(int from, int to);
     QPoint originDelta() const;
 
     /**
      * @brief Snaps moved output to others
-     * @param output the moved output
+     * @param outputIndex row of the moved output
      * @param dest the desired destination to be adjusted by snapping
      */
-    void snap(const Output& output, QPoint& dest);
+    void snap(int outputIndex, QPoint& dest);
+
+    /**
+     * View space geometry of an output that others can snap to.
+     */
+    struct SnapTarget {
+        int id;
+        QRectF rect;
+    };
+
+    /**
+     * @return snap targets vertically close to @p rect in the order of rows.
+     */
+    QVector<SnapTarget> snapCandidates(const QRectF& rect) const;
+    /**
+     * Snaps an output of @p size with @p id at @p dest to @p target if it is close.
+     */
+    static void snapTo(int id, const SnapTarget& target, const QSizeF& size, QPoint& dest);
+    void updateSnapTarget(int outputIndex);
+    void updateSnapTargets();
 
     bool setEnabled(int outputIndex, bool enable);
+    bool setPosition(int outputIndex, QPoint pos);
+    bool setInteractiveMove(int outputIndex, bool move);
 
     bool setResolution(int outputIndex, int resIndex);
     bool setRefreshRate(int outputIndex, int refIndex);
@@ -141,11 +286,10 @@ private:
     int resolutionIndex(const Disman::OutputPtr& output) const;
     int refreshRateIndex(const Disman::OutputPtr& output) const;
     QVariantList resolutionsStrings(const Disman::OutputPtr& output) const;
-    QVector<QSize> resolutions(const Disman::OutputPtr& output) const;
+    QVariantList refreshRatesStrings(const Disman::OutputPtr& output) const;
+    const QVector<QSize>& resolutions(const Disman::OutputPtr& output) const;
     QVector<int> refreshRates(const Disman::OutputPtr& output) const;
 
-    bool positionable(const Output& output) const;
-
     QStringList replicationSourceModel(const Disman::OutputPtr& output) const;
     bool setReplicationSourceIndex(int outputIndex, int sourceIndex);
     int replicationSourceIndex(int outputIndex) const;
@@ -153,7 +297,44 @@ private:
 
     QVariantList replicasModel(const Disman::OutputPtr& output) const;
 
+    void updateReplication(int outputId, int sourceId);
+    void updateReplications();
+    void notifyReplicationSource(int sourceId);
+
     QVector<Output> m_outputs;
+    Geometries m_geometries;
+
+    /**
+     * Right and bottom extremes of positionable outputs in backend coordinates and the ids of
+     * the outputs defining them. Recomputed on the next query when invalidated.
+     */
+    mutable struct Bounds {
+        int right = 0;
+        int bottom = 0;
+        int rightId = 0;
+        int bottomId = 0;
+        bool valid = false;
+    } m_bounds;
+    /** Rows by output id. */
+    QHash<int, int> m_rows;
+    int m_primaryId = 0;
+    /** Id of the output currently dragged in the view or 0. */
+    int m_dragId = 0;
+    QHash<int, QString> m_names;
+
+    /** Replica ids by replication source id. Sources without replicas have no entry. */
+    QHash<int, QVector<int>> m_replicas;
+    /** Replication source id by replica id. */
+    QHash<int, int> m_replicationSources;
+    mutable QHash<int, QStringList> m_replicationSourceModels;
+
+    QHash<int, ModeIndex> m_modeIndices;
+
+    /** Positionable outputs ordered by their top edge in the view. */
+    QVector<SnapTarget> m_snapTargets;
+    qreal m_snapTargetsMaxHeight = 0;
+
+    Changes m_changes;
 
     ConfigHandler* m_config;
 };
@@ -0,0 +1,20 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <disman/output.h>
+
+#include <qqmlintegration.h>
+
+/**
+ * Exposes Disman outputs, in particular their rotation and retention enums, to the QML code of
+ * the module.
+ */
+struct OutputForeign {
+    Q_GADGET
+    QML_FOREIGN(Disman::Output)
+    QML_NAMED_ELEMENT(Output)
+};
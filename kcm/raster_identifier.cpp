@@ -0,0 +1,103 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "raster_identifier.h"
+
+#include <QFontMetrics>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPalette>
+#include <QSurfaceFormat>
+
+// Kirigami's default units the QML identifier is laid out with.
+static const int s_smallSpacing = 4;
+static const int s_largeSpacing = 8;
+
+RasterIdentifier::RasterIdentifier()
+{
+    QSurfaceFormat format;
+    format.setAlphaBufferSize(8);
+    setFormat(format);
+    setFlags(Qt::X11BypassWindowManagerHint | Qt::FramelessWindowHint);
+
+    m_nameFont = QGuiApplication::font();
+    m_nameFont.setPointSizeF(m_nameFont.pointSizeF() * 3);
+    updateLayout();
+}
+
+QString RasterIdentifier::outputName() const
+{
+    return m_outputName;
+}
+
+void RasterIdentifier::setOutputName(const QString& name)
+{
+    if (m_outputName != name) {
+        m_outputName = name;
+        updateLayout();
+    }
+}
+
+QString RasterIdentifier::modeName() const
+{
+    return m_modeName;
+}
+
+void RasterIdentifier::setModeName(const QString& name)
+{
+    if (m_modeName != name) {
+        m_modeName = name;
+        updateLayout();
+    }
+}
+
+void RasterIdentifier::updateLayout()
+{
+    QFontMetrics const nameMetrics(m_nameFont);
+    QFontMetrics const modeMetrics(QGuiApplication::font());
+
+    auto const nameSize = QSize(nameMetrics.horizontalAdvance(m_outputName), nameMetrics.height());
+    auto const modeSize = QSize(modeMetrics.horizontalAdvance(m_modeName), modeMetrics.height());
+    auto const width = std::max(nameSize.width(), modeSize.width());
+
+    // Like in the QML version the mode is centered below the name.
+    auto const left = 2 * s_largeSpacing;
+    m_nameRect = QRect(QPoint(left + (width - nameSize.width()) / 2, s_largeSpacing), nameSize);
+    m_modeRect = QRect(QPoint(left + (width - modeSize.width()) / 2, m_nameRect.bottom() + 1),
+                       modeSize);
+
+    resize(width + 2 * left, nameSize.height() + modeSize.height() + 2 * s_largeSpacing);
+    update();
+}
+
+void RasterIdentifier::paintEvent(QPaintEvent* event)
+{
+    Q_UNUSED(event)
+
+    auto const palette = QGuiApplication::palette();
+    auto background = palette.color(QPalette::Window);
+    background.setAlphaF(0.9);
+    auto const text = palette.color(QPalette::WindowText);
+
+    QPainter painter(this);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(QRect(QPoint(0, 0), size()), Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    auto const border = s_smallSpacing * 1.5;
+    painter.setPen(QPen(text, border));
+    painter.setBrush(background);
+    painter.drawRoundedRect(QRectF(QPointF(0, 0), size()).adjusted(
+                                border / 2, border / 2, -border / 2, -border / 2),
+                            s_smallSpacing * 2,
+                            s_smallSpacing * 2);
+
+    painter.setPen(text);
+    painter.setFont(m_nameFont);
+    painter.drawText(m_nameRect, Qt::AlignCenter, m_outputName);
+    painter.setFont(QGuiApplication::font());
+    painter.drawText(m_modeRect, Qt::AlignCenter, m_modeName);
+}
@@ -0,0 +1,41 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QFont>
+#include <QRasterWindow>
+#include <QRect>
+
+/**
+ * Window painting the labels of OutputIdentifier.qml with QPainter, without a QML engine and
+ * scene graph. The window sizes itself to its labels.
+ */
+class RasterIdentifier : public QRasterWindow
+{
+    Q_OBJECT
+    Q_PROPERTY(QString outputName READ outputName WRITE setOutputName)
+    Q_PROPERTY(QString modeName READ modeName WRITE setModeName)
+
+public:
+    RasterIdentifier();
+
+    QString outputName() const;
+    void setOutputName(const QString& name);
+    QString modeName() const;
+    void setModeName(const QString& name);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    void updateLayout();
+
+    QString m_outputName;
+    QString m_modeName;
+    QFont m_nameFont;
+    QRect m_nameRect;
+    QRect m_modeRect;
+};
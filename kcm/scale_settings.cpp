@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "scale_settings.h"
+
+#include "kcm_kdisplay_debug.h"
+
+#include <KConfig>
+#include <KConfigGroup>
+#include <KSharedConfig>
+
+#include <QElapsedTimer>
+
+namespace ScaleSettings
+{
+
+static KSharedConfigPtr globals()
+{
+    return KSharedConfig::openConfig(QStringLiteral("kdeglobals"));
+}
+
+double read()
+{
+    return globals()->group("KScreen").readEntry("ScaleFactor", 1.0);
+}
+
+/**
+ * Sets @p key in @p group to @p value unless it already has that value.
+ *
+ * @return whether the entry changed.
+ */
+template<typename T>
+static bool update(KConfigGroup group, const char* key, const T& value)
+{
+    if (group.hasKey(key) && group.readEntry(key, T()) == value) {
+        return false;
+    }
+    group.writeEntry(key, value);
+    return true;
+}
+
+static void sync(KConfig& config, const QString& name)
+{
+    if (!config.sync()) {
+        qCWarning(KDISPLAY_KCM) << "Could not write scale settings to" << name;
+    }
+}
+
+int write(double scale, const QStringList& outputNames)
+{
+    // Write env var to be used by session startup scripts to populate the QT_SCREEN_SCALE_FACTORS
+    // env var.
+    // We use QT_SCREEN_SCALE_FACTORS as opposed to QT_SCALE_FACTOR as we need to use one that will
+    // NOT scale fonts according to the scale.
+    // Scaling the fonts makes sense if you don't also set a font DPI, but we NEED to set a font
+    // DPI for both PlasmaShell which does it's own thing, and for KDE4/GTK2 applications.
+    auto const scaleString = QString::number(scale);
+    QString screenFactors;
+    for (auto const& name : outputNames) {
+        screenFactors += name + QLatin1Char('=') + scaleString + QLatin1Char(';');
+    }
+
+    // If dpi is the default (96) remove the entry rather than setting it.
+    auto const fontDpi = qFuzzyCompare(scale, 1.0) ? 0 : qRound(scale * 96.0);
+
+    QElapsedTimer timer;
+    timer.start();
+    int written = 0;
+
+    KConfig fonts(QStringLiteral("kcmfonts"));
+    if (update(fonts.group("General"), "forceFontDPI", fontDpi)) {
+        sync(fonts, QStringLiteral("kcmfonts"));
+        written++;
+    }
+
+    auto const config = globals();
+    auto group = config->group("KScreen");
+    auto changed = update(group, "ScreenScaleFactors", screenFactors);
+    changed |= update(group, "ScaleFactor", scale);
+    if (changed) {
+        sync(*config, QStringLiteral("kdeglobals"));
+        written++;
+    }
+
+    qCDebug(KDISPLAY_KCM) << "Wrote scale settings to" << written << "files in" << timer.elapsed()
+                          << "ms.";
+    return fontDpi;
+}
+
+}
@@ -0,0 +1,31 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include <QStringList>
+
+/**
+ * Persists the global scale. All entries are computed before any file is touched, files whose
+ * entries are unchanged are not written, and every written file is synced exactly once.
+ */
+namespace ScaleSettings
+{
+
+/**
+ * @return the global scale or 1 if none is set.
+ */
+double read();
+
+/**
+ * Writes @p scale for the outputs with @p outputNames together with the font DPI derived from
+ * it. The font settings are written first and the scale factor last, so an interrupted write
+ * leaves the previous scale in place, which is then written again on the next save.
+ *
+ * @return the font DPI that was written, 0 for the default DPI.
+ */
+int write(double scale, const QStringList& outputNames);
+
+}
@@ -27,8 +27,9 @@ QQC2.ScrollView {
         totalSize = kcm.normalizeScreen();
     }
 
-    onWidthChanged: resetTotalSize()
-    onHeightChanged: resetTotalSize()
+    // Resizing the view does not change the outputs, only query the size.
+    onWidthChanged: totalSize = kcm.screenSize()
+    onHeightChanged: totalSize = kcm.screenSize()
 
     readonly property real relativeFactor: {
         var relativeSize = Qt.size(totalSize.width / (0.6 * width),
@@ -33,6 +33,7 @@ KCM.SimpleKCM {
                                              || errSaveMsg.visible
                                              || scaleMsg.visible
                                              || connectMsg.visible
+                                             || saveMsg.visible
 
     implicitWidth: Kirigami.Units.gridUnit * 32
     implicitHeight: Kirigami.Units.gridUnit * 30
@@ -44,6 +45,17 @@ KCM.SimpleKCM {
     // This is to fix Output dragging
     flickable.interactive: Kirigami.Settings.hasTransientTouchInput
 
+    QtQuick.Shortcut {
+        sequences: [QtQuick.StandardKey.Undo]
+        enabled: kcm.canUndo
+        onActivated: kcm.undo()
+    }
+    QtQuick.Shortcut {
+        sequences: [QtQuick.StandardKey.Redo]
+        enabled: kcm.canRedo
+        onActivated: kcm.redo()
+    }
+
     QtQuick.Connections {
         target: kcm
         function onInvalidConfig(reason) {
@@ -62,9 +74,9 @@ KCM.SimpleKCM {
         }
         function onOutputConnect(connected) {
             if (connected) {
-                connectMsg.text = i18n("A new output has been added. Settings have been reloaded.");
+                connectMsg.text = i18n("A new output has been added. Settings have been updated.");
             } else {
-                connectMsg.text = i18n("An output has been removed. Settings have been reloaded.");
+                connectMsg.text = i18n("An output has been removed. Settings have been updated.");
             }
             connectMsg.visible = true;
         }
@@ -135,6 +147,17 @@ KCM.SimpleKCM {
                 }
             ]
         }
+        Kirigami.InlineMessage {
+            id: saveMsg
+            Layout.fillWidth: true
+            Layout.leftMargin: root.topMargins
+            Layout.rightMargin: root.topMargins
+            type: Kirigami.MessageType.Information
+            text: i18n("Applying display configuration…")
+            visible: kcm.saveState === KDisplay.KCMKDisplay.Applying
+                     || kcm.saveState === KDisplay.KCMKDisplay.Confirming
+            showCloseButton: false
+        }
         Kirigami.InlineMessage {
             id: connectMsg
             Layout.fillWidth: true
@@ -164,9 +187,9 @@ KCM.SimpleKCM {
             function onOutputConnect(connected) {
                 root.selectedOutput = 0;
                 if (connected) {
-                    connectMsg.text = i18n("A new output has been added. Settings have been reloaded.");
+                    connectMsg.text = i18n("A new output has been added. Settings have been updated.");
                 } else {
-                    connectMsg.text = i18n("An output has been removed. Settings have been reloaded.");
+                    connectMsg.text = i18n("An output has been removed. Settings have been updated.");
                 }
                 connectMsg.visible = true;
             }
@@ -8,7 +8,9 @@
 */
 #include "daemon.h"
 
+#include "../../common/config_diff.h"
 #include "../../common/orientation_sensor.h"
+#include "../../common/utils.h"
 #include "config.h"
 #include "generator.h"
 #include "kdisplay_daemon_debug.h"
@@ -53,6 +55,7 @@ void KDisplayDaemon::init(Disman::ConfigOperation* op)
     }
 
     m_monitoredConfig = qobject_cast<Disman::GetConfigOperation*>(op)->config();
+    m_appliedConfig = m_monitoredConfig->clone();
     auto cfg = m_monitoredConfig.get();
 
     qCDebug(KDISPLAY_KDED) << "Config" << cfg << "is ready";
@@ -79,8 +82,8 @@ void KDisplayDaemon::init(Disman::ConfigOperation* op)
     m_osdServiceInterface->setTimeout(
         std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::seconds(60)).count());
 
-    connect(cfg, &Disman::Config::output_added, this, &KDisplayDaemon::applyConfig);
-    connect(cfg, &Disman::Config::output_removed, this, &KDisplayDaemon::applyConfig);
+    connect(cfg, &Disman::Config::output_added, this, &KDisplayDaemon::topologyChanged);
+    connect(cfg, &Disman::Config::output_removed, this, &KDisplayDaemon::topologyChanged);
 
     connect(m_orientationSensor,
             &OrientationSensor::availableChanged,
@@ -128,6 +131,11 @@ void KDisplayDaemon::updateOrientation()
         return;
     }
 
+    applyOrientation(orientation);
+}
+
+void KDisplayDaemon::applyOrientation(QOrientationReading::Orientation orientation)
+{
     Config(m_monitoredConfig).setDeviceOrientation(orientation);
     if (m_monitoring) {
         doApplyConfig(m_monitoredConfig);
@@ -146,24 +154,56 @@ void KDisplayDaemon::doApplyConfig(Disman::ConfigPtr const& config)
 
 void KDisplayDaemon::refreshConfig()
 {
-    setMonitorForChanges(false);
     m_configDirty = false;
+
+    auto const delta = ConfigDiff::compute(m_monitoredConfig, m_appliedConfig);
+    if (delta.isEmpty()) {
+        qCDebug(KDISPLAY_KDED) << "Config unchanged, nothing to apply";
+        // Monitoring is off when the config changed again while the last one was applied.
+        setMonitorForChanges(true);
+        finishTopologyChange();
+        return;
+    }
+    qCDebug(KDISPLAY_KDED) << "Applying" << delta;
+
+    setMonitorForChanges(false);
     Disman::ConfigMonitor::instance()->add_config(m_monitoredConfig);
 
-    connect(new Disman::SetConfigOperation(m_monitoredConfig),
+    // The monitored config might change again while the operation runs, for example on rotation.
+    // Only what is sent counts as applied, so later changes are still found in the next delta.
+    auto const sent = m_monitoredConfig->clone();
+    connect(new Disman::SetConfigOperation(sent),
             &Disman::SetConfigOperation::finished,
             this,
-            [this]() {
+            [this, sent]() {
                 qCDebug(KDISPLAY_KDED) << "Config applied";
+                m_appliedConfig = sent;
                 if (m_configDirty) {
                     // Config changed in the meantime again, apply.
                     doApplyConfig(m_monitoredConfig);
                 } else {
                     setMonitorForChanges(true);
+                    finishTopologyChange();
                 }
             });
 }
 
+void KDisplayDaemon::topologyChanged()
+{
+    m_topologyChanging = true;
+    applyConfig();
+}
+
+void KDisplayDaemon::finishTopologyChange()
+{
+    if (!m_topologyChanging) {
+        return;
+    }
+    m_topologyChanging = false;
+    qCDebug(KDISPLAY_KDED) << "Config for changed outputs applied";
+    Q_EMIT topologyApplied(Utils::outputHashes(m_monitoredConfig));
+}
+
 void KDisplayDaemon::applyConfig()
 {
     qCDebug(KDISPLAY_KDED) << "Applying config";
@@ -176,6 +216,9 @@ void KDisplayDaemon::applyConfig()
         show_osd();
     } else {
         m_osdServiceInterface->hideOsd();
+
+        // The backend has set up the outputs already.
+        finishTopologyChange();
     }
 }
 
@@ -214,12 +257,15 @@ void KDisplayDaemon::applyOsdAction(KDisplay::OsdAction::Action action)
 
     if (auto config = Generator::displaySwitch(action, m_monitoredConfig)) {
         doApplyConfig(config);
+    } else {
+        finishTopologyChange();
     }
 }
 
 void KDisplayDaemon::configChanged()
 {
     qCDebug(KDISPLAY_KDED) << "Change detected" << m_monitoredConfig;
+    m_appliedConfig = m_monitoredConfig->clone();
 
     update_auto_rotate();
     updateOrientation();
@@ -233,6 +279,7 @@ void KDisplayDaemon::show_osd()
         watcher->deleteLater();
         QDBusReply<int> reply = *watcher;
         if (!reply.isValid()) {
+            finishTopologyChange();
             return;
         }
         applyOsdAction(static_cast<KDisplay::OsdAction::Action>(reply.value()));
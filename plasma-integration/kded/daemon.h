@@ -13,6 +13,8 @@
 
 #include <kdedmodule.h>
 
+#include <QOrientationReading>
+#include <QStringList>
 #include <QVariant>
 
 class OrgKwinftKdisplayOsdServiceInterface;
@@ -38,13 +40,24 @@ public Q_SLOTS:
     bool getAutoRotate();
     void setAutoRotate(bool value);
 
+Q_SIGNALS:
+    /**
+     * Sent over D-Bus once the config for connected or disconnected outputs has been applied or
+     * there was nothing to apply. @p outputs are the hashes of the outputs then connected.
+     */
+    void topologyApplied(const QStringList& outputs);
+
 private:
+    friend class TestDaemon;
+
     void init(Disman::ConfigOperation* op);
 
     void applyConfig();
     void configChanged();
     void displayButton();
     void setMonitorForChanges(bool enabled);
+    void topologyChanged();
+    void finishTopologyChange();
 
     void show_osd();
     void applyOsdAction(KDisplay::OsdAction::Action action);
@@ -54,13 +67,18 @@ private:
 
     void update_auto_rotate();
     void updateOrientation();
+    void applyOrientation(QOrientationReading::Orientation orientation);
 
     Disman::ConfigPtr m_monitoredConfig;
+    /** State of the backend as of the last apply or reported change. */
+    Disman::ConfigPtr m_appliedConfig;
     bool m_monitoring;
     bool m_configDirty = true;
     OrgKwinftKdisplayOsdServiceInterface* m_osdServiceInterface;
     OrientationSensor* m_orientationSensor;
     bool m_startingUp = true;
+    /** Whether outputs were connected or disconnected and the resulting config is not applied. */
+    bool m_topologyChanging = false;
 };
 
 #endif /*KSCREEN_DAEMON_H*/
@@ -38,7 +38,8 @@ void Osd::showActionSelector()
         m_osdActionSelector = std::make_unique<QQuickView>(&m_engine, nullptr);
         m_osdActionSelector->setInitialProperties(
             {{QLatin1String("actions"), QVariant::fromValue(OsdAction::availableActions())}});
-        m_osdActionSelector->setSource(QUrl(QStringLiteral("qrc:/qml/OsdSelector.qml")));
+        m_osdActionSelector->setSource(
+            QUrl(QStringLiteral("qrc:/qt/qml/org/kwinft/kdisplay/OsdSelector.qml")));
         m_osdActionSelector->setColor(Qt::transparent);
         m_osdActionSelector->setFlag(Qt::FramelessWindowHint);
 
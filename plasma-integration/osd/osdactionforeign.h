@@ -0,0 +1,25 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#pragma once
+
+#include "osdaction.h"
+
+#include <qqmlintegration.h>
+
+namespace KDisplay
+{
+
+/**
+ * Exposes the actions to QML as OsdAction.SwitchToExternal and so on.
+ */
+namespace OsdActionForeign
+{
+Q_NAMESPACE
+QML_NAMED_ELEMENT(OsdAction)
+QML_FOREIGN_NAMESPACE(KDisplay::OsdAction)
+}
+
+}
@@ -8,9 +8,9 @@
 #include "osd.h"
 #include "osdserviceadaptor.h"
 
+#include <QCoreApplication>
 #include <QDBusConnection>
 #include <QDBusMessage>
-#include <QQmlEngine>
 #include <disman/config.h>
 #include <disman/getconfigoperation.h>
 #include <disman/output.h>
@@ -21,8 +21,6 @@ OsdManager::OsdManager(QObject* parent)
     : QObject(parent)
     , m_cleanupTimer(new QTimer(this))
 {
-    qmlRegisterUncreatableType<KDisplay::OsdAction>(
-        "org.kwinft.kdisplay", 1, 0, "OsdAction", QStringLiteral("Can't create OsdAction"));
     new OsdServiceAdaptor(this);
 
     // free up memory when the osd hasn't been used for more than 1 minute
@@ -23,7 +23,6 @@
 #include "kdisplay_applet.h"
 
 #include <QMetaEnum>
-#include <QQmlEngine> // for qmlRegisterType
 
 #include <QDBusConnection>
 #include <QDBusMessage>
@@ -40,8 +39,6 @@ KDisplayApplet::KDisplayApplet(QObject* parent,
                                const QVariantList& args)
     : Plasma::Applet(parent, data, args)
 {
-    qmlRegisterUncreatableType<KDisplay::OsdAction>(
-        "org.kwinft.private.kdisplay", 1, 0, "OsdAction", QStringLiteral("Can't create OsdAction"));
 }
 
 KDisplayApplet::~KDisplayApplet() = default;
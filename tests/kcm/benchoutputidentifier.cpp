@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "../../kcm/output_identifier.h"
+
+#include <QFile>
+#include <QGuiApplication>
+#include <QObject>
+#include <QWindow>
+#include <QtTest>
+
+#include <disman/backendmanager_p.h>
+#include <disman/config.h>
+#include <disman/getconfigoperation.h>
+
+#include <unistd.h>
+
+/**
+ * Compares the QML and the raster identifiers on their first showing, which includes creating
+ * the engine, component and windows, by the time until all windows are exposed and the resident
+ * memory they add. Libraries loaded by an earlier row count for later ones too, so for memory
+ * numbers run a single row, for example "benchoutputidentifier identify:raster".
+ */
+class BenchOutputIdentifier : public QObject
+{
+    Q_OBJECT
+
+private:
+    Disman::ConfigPtr m_config;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void identify_data();
+    void identify();
+};
+
+/**
+ * @return resident memory of the process in KiB or 0 if it is not known.
+ */
+static qint64 residentMemory()
+{
+    QFile file(QStringLiteral("/proc/self/statm"));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    auto const pages = file.readAll().split(' ');
+    if (pages.size() < 2) {
+        return 0;
+    }
+    return pages.at(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+void BenchOutputIdentifier::initTestCase()
+{
+    qputenv("DISMAN_IN_PROCESS", "1");
+    qputenv("DISMAN_LOGGING", "false");
+    qputenv("DISMAN_BACKEND_ARGS",
+            "TEST_DATA=" TEST_DATA "configs/laptopLidOpenAndTwoExternal.json");
+    setenv("DISMAN_BACKEND", "fake", 1);
+
+    auto op = new Disman::GetConfigOperation;
+    QVERIFY(op->exec());
+    m_config = op->config();
+}
+
+void BenchOutputIdentifier::cleanupTestCase()
+{
+    m_config.reset();
+    Disman::BackendManager::instance()->shutdown_backend();
+}
+
+void BenchOutputIdentifier::identify_data()
+{
+    QTest::addColumn<QByteArray>("backend");
+
+    QTest::addRow("qml") << QByteArray("qml");
+    QTest::addRow("raster") << QByteArray("raster");
+}
+
+void BenchOutputIdentifier::identify()
+{
+    QFETCH(QByteArray, backend);
+    qputenv("KDISPLAY_IDENTIFIER", backend);
+
+    auto const before = residentMemory();
+    qint64 after = 0;
+
+    // Only the first showing is of interest, later ones reuse everything.
+    QBENCHMARK_ONCE {
+        OutputIdentifier identifier;
+        identifier.identify(m_config);
+        if (!identifier.isActive()) {
+            QSKIP("Identifiers could not be created.");
+        }
+
+        auto const windows = QGuiApplication::topLevelWindows();
+        for (auto window : windows) {
+            if (window->isVisible()) {
+                QVERIFY(QTest::qWaitForWindowExposed(window));
+            }
+        }
+        after = residentMemory();
+    }
+
+    qDebug() << backend << "identifiers added" << after - before << "KiB resident memory.";
+}
+
+QTEST_MAIN(BenchOutputIdentifier)
+
+#include "benchoutputidentifier.moc"
@@ -0,0 +1,374 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "../../kcm/config_handler.h"
+#include "../../kcm/output_model.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QObject>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <disman/backendmanager_p.h>
+#include <disman/config.h>
+#include <disman/getconfigoperation.h>
+#include <disman/output.h>
+
+#include <memory>
+
+/**
+ * Benchmarks the KCM model on generated topologies with many outputs and modes. Each output
+ * offers every combination of the sizes and refresh rates below.
+ */
+class BenchOutputModel : public QObject
+{
+    Q_OBJECT
+
+private:
+    void addTopologies();
+    QByteArray writeConfig(int outputCount);
+    bool loadConfig(int outputCount);
+    QModelIndex index(int row) const;
+
+    QTemporaryDir m_dir;
+    std::unique_ptr<ConfigHandler> m_handler;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void cleanup();
+
+    void data_data();
+    void data();
+    void drag_data();
+    void drag();
+    void snap_data();
+    void snap();
+    void checkNeedsSave_data();
+    void checkNeedsSave();
+    void addRemove_data();
+    void addRemove();
+    void normalizePositions_data();
+    void normalizePositions();
+    void undoRedo_data();
+    void undoRedo();
+};
+
+static const QVector<QSize> s_sizes = {{3840, 2160},
+                                       {3440, 1440},
+                                       {2560, 1600},
+                                       {2560, 1440},
+                                       {1920, 1200},
+                                       {1920, 1080},
+                                       {1680, 1050},
+                                       {1600, 900},
+                                       {1440, 900},
+                                       {1280, 1024},
+                                       {1280, 720},
+                                       {1024, 768}};
+static const QVector<double> s_refreshRates = {144., 120., 75., 60., 59.94};
+
+/** Outputs per row of the generated grid. */
+static const int s_columns = 8;
+
+void BenchOutputModel::addTopologies()
+{
+    QTest::addColumn<int>("outputs");
+
+    for (auto count : {2, 8, 32, 128}) {
+        QTest::addRow("%d outputs", count) << count;
+    }
+}
+
+QByteArray BenchOutputModel::writeConfig(int outputCount)
+{
+    auto const largest = s_sizes.first();
+
+    QJsonArray outputs;
+    for (int i = 0; i < outputCount; i++) {
+        QJsonArray modes;
+        int modeId = 1;
+        for (auto const& size : s_sizes) {
+            for (auto rate : s_refreshRates) {
+                modes.append(QJsonObject{
+                    {"id", modeId++},
+                    {"name", QStringLiteral("%1x%2").arg(size.width()).arg(size.height())},
+                    {"refreshRate", rate},
+                    {"size", QJsonObject{{"width", size.width()}, {"height", size.height()}}},
+                });
+            }
+        }
+
+        auto const pos = QJsonObject{{"x", (i % s_columns) * largest.width()},
+                                     {"y", (i / s_columns) * largest.height()}};
+        outputs.append(QJsonObject{
+            {"id", i + 1},
+            {"name", QStringLiteral("DP-%1").arg(i + 1)},
+            {"type", i == 0 ? "LVDS" : "HDMI"},
+            {"modes", modes},
+            {"pos", pos},
+            {"currentModeId", 1},
+            {"preferredModes", QJsonArray{1}},
+            {"rotation", 1},
+            {"connected", true},
+            {"enabled", true},
+            {"primary", i == 0},
+        });
+    }
+
+    auto const screen = QJsonObject{
+        {"id", 1},
+        {"maxSize", QJsonObject{{"width", 65535}, {"height", 65535}}},
+        {"minSize", QJsonObject{{"width", 320}, {"height", 200}}},
+        {"currentSize",
+         QJsonObject{{"width", std::min(outputCount, s_columns) * largest.width()},
+                     {"height", ((outputCount - 1) / s_columns + 1) * largest.height()}}},
+        {"maxActiveOutputsCount", outputCount},
+    };
+
+    auto const path = m_dir.filePath(QStringLiteral("outputs%1.json").arg(outputCount));
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QByteArray();
+    }
+    file.write(QJsonDocument(QJsonObject{{"screen", screen}, {"outputs", outputs}}).toJson());
+    return path.toUtf8();
+}
+
+bool BenchOutputModel::loadConfig(int outputCount)
+{
+    Disman::BackendManager::instance()->shutdown_backend();
+
+    auto const path = writeConfig(outputCount);
+    if (path.isEmpty()) {
+        qWarning() << "Could not write config with" << outputCount << "outputs.";
+        return false;
+    }
+    qputenv("DISMAN_BACKEND_ARGS", "TEST_DATA=" + path);
+
+    auto op = new Disman::GetConfigOperation;
+    if (!op->exec()) {
+        qWarning() << op->error_string();
+        return false;
+    }
+
+    auto config = op->config();
+    config->set_supported_features(Disman::Config::Feature::PrimaryDisplay
+                                   | Disman::Config::Feature::OutputReplication);
+
+    m_handler = std::make_unique<ConfigHandler>();
+    m_handler->setConfig(config);
+    return m_handler->outputModel()->rowCount() == outputCount;
+}
+
+QModelIndex BenchOutputModel::index(int row) const
+{
+    return m_handler->outputModel()->index(row);
+}
+
+void BenchOutputModel::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    qputenv("DISMAN_IN_PROCESS", "1");
+    qputenv("DISMAN_LOGGING", "false");
+    setenv("DISMAN_BACKEND", "fake", 1);
+}
+
+void BenchOutputModel::cleanupTestCase()
+{
+    Disman::BackendManager::instance()->shutdown_backend();
+}
+
+void BenchOutputModel::cleanup()
+{
+    m_handler.reset();
+}
+
+void BenchOutputModel::data_data()
+{
+    QTest::addColumn<int>("outputs");
+    QTest::addColumn<int>("role");
+
+    const QVector<QPair<int, const char*>> roles = {
+        {Qt::DisplayRole, "display"},
+        {OutputModel::SizeRole, "size"},
+        {OutputModel::PositionRole, "position"},
+        {OutputModel::NormalizedPositionRole, "normalizedPosition"},
+        {OutputModel::ResolutionIndexRole, "resolutionIndex"},
+        {OutputModel::ResolutionsRole, "resolutions"},
+        {OutputModel::RefreshRateIndexRole, "refreshRateIndex"},
+        {OutputModel::RefreshRatesRole, "refreshRates"},
+        {OutputModel::ReplicationSourceModelRole, "replicationSourceModel"},
+        {OutputModel::ReplicationSourceIndexRole, "replicationSourceIndex"},
+        {OutputModel::ReplicasModelRole, "replicasModel"},
+    };
+
+    for (auto count : {2, 8, 32, 128}) {
+        for (auto const& [role, name] : roles) {
+            QTest::addRow("%d outputs, %s", count, name) << count << role;
+        }
+    }
+}
+
+void BenchOutputModel::data()
+{
+    QFETCH(int, outputs);
+    QFETCH(int, role);
+    QVERIFY(loadConfig(outputs));
+
+    auto model = m_handler->outputModel();
+
+    // Like a view updating all delegates.
+    QBENCHMARK {
+        for (int i = 0; i < outputs; i++) {
+            model->data(index(i), role);
+        }
+    }
+}
+
+void BenchOutputModel::drag_data()
+{
+    addTopologies();
+}
+
+void BenchOutputModel::drag()
+{
+    QFETCH(int, outputs);
+    QVERIFY(loadConfig(outputs));
+
+    auto model = m_handler->outputModel();
+    QPersistentModelIndex const dragged = index(0);
+    auto const start = model->data(dragged, OutputModel::PositionRole).toPoint();
+    int step = 0;
+
+    // Moves the first output in steps over the width of its row, which also reorders rows.
+    QBENCHMARK {
+        auto const x = (step++ % (2 * s_columns)) * s_sizes.first().width() / 2;
+        model->setData(dragged, start + QPoint(x, 1), OutputModel::PositionRole);
+    }
+}
+
+void BenchOutputModel::snap_data()
+{
+    addTopologies();
+}
+
+void BenchOutputModel::snap()
+{
+    QFETCH(int, outputs);
+    QVERIFY(loadConfig(outputs));
+
+    auto model = m_handler->outputModel();
+    auto const row = outputs / 2;
+    auto const start = model->data(index(row), OutputModel::PositionRole).toPoint();
+    int step = 0;
+
+    // While the output is moved interactively setting its position only snaps it to others.
+    model->setData(index(row), true, OutputModel::InteractiveMoveRole);
+    QBENCHMARK {
+        auto const offset = QPoint(step % 50 - 25, step / 50 % 50 - 25);
+        step++;
+        model->setData(index(row), start + offset, OutputModel::PositionRole);
+    }
+    model->setData(index(row), false, OutputModel::InteractiveMoveRole);
+}
+
+void BenchOutputModel::checkNeedsSave_data()
+{
+    addTopologies();
+}
+
+void BenchOutputModel::checkNeedsSave()
+{
+    QFETCH(int, outputs);
+    QVERIFY(loadConfig(outputs));
+
+    QSignalSpy spy(m_handler.get(), &ConfigHandler::needsSaveChecked);
+
+    // The check runs deferred, so include delivering it.
+    QBENCHMARK {
+        m_handler->checkNeedsSave();
+        QCoreApplication::sendPostedEvents(m_handler.get(), QEvent::MetaCall);
+    }
+    QVERIFY(!spy.isEmpty());
+    QCOMPARE(spy.last().first().toBool(), false);
+}
+
+void BenchOutputModel::addRemove_data()
+{
+    addTopologies();
+}
+
+void BenchOutputModel::addRemove()
+{
+    QFETCH(int, outputs);
+    QVERIFY(loadConfig(outputs));
+
+    auto model = m_handler->outputModel();
+    auto const output = m_handler->config()->outputs().at(outputs / 2 + 1);
+
+    QBENCHMARK {
+        model->remove(output->id());
+        model->add(output);
+    }
+    QCOMPARE(model->rowCount(), outputs);
+}
+
+void BenchOutputModel::normalizePositions_data()
+{
+    addTopologies();
+}
+
+void BenchOutputModel::normalizePositions()
+{
+    QFETCH(int, outputs);
+    QVERIFY(loadConfig(outputs));
+
+    auto model = m_handler->outputModel();
+    QPersistentModelIndex const moved = index(model->rowCount() - 1);
+    auto const shift = QPoint(s_columns * s_sizes.first().width(), 0);
+    int step = 0;
+
+    // Moving the last output to the far left and back shifts the origin for all other outputs
+    // on every second step. Normalizing then resets all view positions.
+    QBENCHMARK {
+        auto const current = model->data(moved, OutputModel::PositionRole).toPoint();
+        auto const dest = step++ % 2 ? current + shift : current - shift;
+        model->setData(moved, dest, OutputModel::PositionRole);
+        m_handler->normalizeScreen();
+    }
+}
+
+void BenchOutputModel::undoRedo_data()
+{
+    addTopologies();
+}
+
+void BenchOutputModel::undoRedo()
+{
+    QFETCH(int, outputs);
+    QVERIFY(loadConfig(outputs));
+
+    auto model = m_handler->outputModel();
+    auto const rotation = model->data(index(0), OutputModel::RotationRole);
+
+    // A single changed output is recorded, reverted and restored independent of the others.
+    QBENCHMARK {
+        model->setData(
+            index(0), QVariant::fromValue(Disman::Output::Left), OutputModel::RotationRole);
+        m_handler->undo();
+        m_handler->redo();
+        m_handler->undo();
+    }
+    QVERIFY(m_handler->canRedo());
+    QCOMPARE(model->data(index(0), OutputModel::RotationRole), rotation);
+}
+
+QTEST_MAIN(BenchOutputModel)
+
+#include "benchoutputmodel.moc"
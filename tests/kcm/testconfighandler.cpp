@@ -0,0 +1,293 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "../../kcm/config_handler.h"
+#include "../../kcm/output_model.h"
+
+#include "../../common/utils.h"
+
+#include <QObject>
+#include <QtTest>
+
+#include <disman/backendmanager_p.h>
+#include <disman/config.h>
+#include <disman/getconfigoperation.h>
+#include <disman/mode.h>
+#include <disman/output.h>
+
+#include <memory>
+
+/**
+ * Tests how the KCM merges changes reported by the backend into the user's edits and how undo
+ * and redo behave afterwards. Backend reports are simulated by changing the config the monitor
+ * would update and merging it like the monitor's signal does.
+ */
+class TestConfigHandler : public QObject
+{
+    Q_OBJECT
+
+private:
+    void load(const QByteArray& fileName);
+    Disman::OutputPtr output(int outputId) const;
+    Disman::OutputPtr backendOutput(int outputId) const;
+    void merge();
+    void setRotation(int row, Disman::Output::Rotation rotation);
+    bool needsSave();
+
+    std::unique_ptr<ConfigHandler> m_handler;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    void mergeUntouchedField();
+    void keepEditedField();
+    void mergeOtherFieldOfEditedOutput();
+    void adoptEditReportedByBackend();
+    void mergeModes();
+    void compareModesByValue();
+    void removeOutputWithSharedHash();
+    void undoAfterMerge();
+    void redoAfterMerge();
+    void delta();
+};
+
+void TestConfigHandler::load(const QByteArray& fileName)
+{
+    m_handler.reset();
+    Disman::BackendManager::instance()->shutdown_backend();
+    qputenv("DISMAN_BACKEND_ARGS", "TEST_DATA=" TEST_DATA "configs/" + fileName);
+
+    auto op = new Disman::GetConfigOperation;
+    QVERIFY(op->exec());
+
+    m_handler = std::make_unique<ConfigHandler>();
+    m_handler->setConfig(op->config());
+}
+
+Disman::OutputPtr TestConfigHandler::output(int outputId) const
+{
+    return m_handler->config()->outputs().at(outputId);
+}
+
+Disman::OutputPtr TestConfigHandler::backendOutput(int outputId) const
+{
+    return m_handler->m_backendConfig->outputs().at(outputId);
+}
+
+void TestConfigHandler::merge()
+{
+    m_handler->mergeBackendChanges();
+}
+
+void TestConfigHandler::setRotation(int row, Disman::Output::Rotation rotation)
+{
+    auto model = m_handler->outputModel();
+    QVERIFY(model->setData(
+        model->index(row), QVariant::fromValue(rotation), OutputModel::RotationRole));
+}
+
+bool TestConfigHandler::needsSave()
+{
+    QSignalSpy spy(m_handler.get(), &ConfigHandler::needsSaveChecked);
+    m_handler->checkNeedsSave();
+    QCoreApplication::sendPostedEvents(m_handler.get(), QEvent::MetaCall);
+    return !spy.isEmpty() && spy.last().first().toBool();
+}
+
+void TestConfigHandler::initTestCase()
+{
+    qputenv("DISMAN_IN_PROCESS", "1");
+    qputenv("DISMAN_LOGGING", "false");
+    setenv("DISMAN_BACKEND", "fake", 1);
+}
+
+void TestConfigHandler::cleanupTestCase()
+{
+    Disman::BackendManager::instance()->shutdown_backend();
+}
+
+void TestConfigHandler::init()
+{
+    load("workstaionTwoExternalSameSize.json");
+    QVERIFY(m_handler);
+    QCOMPARE(m_handler->outputModel()->rowCount(), 2);
+
+    // The outputs are ordered by position, the first row is output 1.
+    QCOMPARE(m_handler->outputModel()->data(m_handler->outputModel()->index(0)).toString(),
+             Utils::outputName(output(1)));
+    QVERIFY(!needsSave());
+}
+
+void TestConfigHandler::cleanup()
+{
+    m_handler.reset();
+}
+
+void TestConfigHandler::mergeUntouchedField()
+{
+    backendOutput(2)->set_rotation(Disman::Output::Left);
+    merge();
+
+    QCOMPARE(output(2)->rotation(), Disman::Output::Left);
+    QVERIFY(!needsSave());
+    QVERIFY(m_handler->delta().isEmpty());
+    QVERIFY(!m_handler->canUndo());
+}
+
+void TestConfigHandler::keepEditedField()
+{
+    setRotation(0, Disman::Output::Left);
+
+    backendOutput(1)->set_rotation(Disman::Output::Right);
+    merge();
+
+    QCOMPARE(output(1)->rotation(), Disman::Output::Left);
+    QVERIFY(needsSave());
+
+    auto const delta = m_handler->delta();
+    QCOMPARE(delta.outputs.size(), 1);
+    QCOMPARE(delta.outputs.value(1), ConfigDiff::Fields(ConfigDiff::Field::Rotation));
+}
+
+void TestConfigHandler::mergeOtherFieldOfEditedOutput()
+{
+    setRotation(0, Disman::Output::Left);
+
+    auto const position = backendOutput(1)->position() + QPointF(0, 100);
+    backendOutput(1)->set_position(position);
+    merge();
+
+    QCOMPARE(output(1)->rotation(), Disman::Output::Left);
+    QCOMPARE(output(1)->position(), position);
+    QVERIFY(needsSave());
+    QCOMPARE(m_handler->delta().outputs.value(1),
+             ConfigDiff::Fields(ConfigDiff::Field::Rotation));
+}
+
+void TestConfigHandler::adoptEditReportedByBackend()
+{
+    setRotation(0, Disman::Output::Left);
+    QVERIFY(needsSave());
+
+    // For example the config was applied from elsewhere.
+    backendOutput(1)->set_rotation(Disman::Output::Left);
+    merge();
+
+    QCOMPARE(output(1)->rotation(), Disman::Output::Left);
+    QVERIFY(!needsSave());
+    QVERIFY(m_handler->delta().isEmpty());
+}
+
+void TestConfigHandler::mergeModes()
+{
+    auto model = m_handler->outputModel();
+    auto const resolutions = model->data(model->index(0), OutputModel::ResolutionsRole).toList();
+
+    // The smallest mode is not the current one.
+    auto modes = backendOutput(1)->modes();
+    QVERIFY(modes.erase("1"));
+    backendOutput(1)->set_modes(modes);
+    merge();
+
+    QCOMPARE(output(1)->modes().size(), modes.size());
+    QCOMPARE(model->data(model->index(0), OutputModel::ResolutionsRole).toList().size(),
+             resolutions.size() - 1);
+    QVERIFY(!needsSave());
+}
+
+void TestConfigHandler::compareModesByValue()
+{
+    ConfigDiff::OutputState const state(output(1));
+    QVERIFY(state.mode);
+
+    // A mode list reported later names another resolution with the id of the current mode.
+    auto other = state;
+    other.mode = state.mode->clone();
+    other.mode->set_size(QSize(800, 600));
+    QCOMPARE(ConfigDiff::compare(other, state, ConfigDiff::AllFields),
+             ConfigDiff::Fields(ConfigDiff::Field::Mode));
+
+    other.mode = state.mode->clone();
+    QCOMPARE(ConfigDiff::compare(other, state, ConfigDiff::AllFields), ConfigDiff::Fields());
+}
+
+void TestConfigHandler::removeOutputWithSharedHash()
+{
+    // Outputs 2 and 3 are monitors of the same model.
+    load("laptopLidOpenAndTwoExternal.json");
+    QVERIFY(m_handler);
+    QCOMPARE(output(2)->hash(), output(3)->hash());
+    QVERIFY(m_handler->delta().isEmpty());
+
+    m_handler->m_backendConfig->remove_output(3);
+    QCOMPARE(m_handler->config()->outputs().size(), 2);
+
+    // The remaining monitor still has its initial state.
+    QVERIFY(m_handler->delta().isEmpty());
+    QVERIFY(!needsSave());
+}
+
+void TestConfigHandler::undoAfterMerge()
+{
+    auto const rotation = output(1)->rotation();
+    setRotation(0, Disman::Output::Left);
+    QVERIFY(m_handler->canUndo());
+
+    auto const position = backendOutput(1)->position() + QPointF(0, 100);
+    backendOutput(1)->set_position(position);
+    merge();
+
+    // Only the user's change is reverted, the merged position stays.
+    m_handler->undo();
+    QCOMPARE(output(1)->rotation(), rotation);
+    QCOMPARE(output(1)->position(), position);
+    QVERIFY(!needsSave());
+    QVERIFY(m_handler->delta().isEmpty());
+    QVERIFY(m_handler->canRedo());
+}
+
+void TestConfigHandler::redoAfterMerge()
+{
+    setRotation(0, Disman::Output::Left);
+    m_handler->undo();
+
+    auto const position = backendOutput(1)->position() + QPointF(0, 100);
+    backendOutput(1)->set_position(position);
+    merge();
+
+    m_handler->redo();
+    QCOMPARE(output(1)->rotation(), Disman::Output::Left);
+    QCOMPARE(output(1)->position(), position);
+    QVERIFY(needsSave());
+    QCOMPARE(m_handler->delta().outputs.value(1),
+             ConfigDiff::Fields(ConfigDiff::Field::Rotation));
+}
+
+void TestConfigHandler::delta()
+{
+    auto const base = m_handler->config()->clone();
+
+    output(2)->set_enabled(false);
+    auto delta = ConfigDiff::compute(m_handler->config(), base);
+    QCOMPARE(delta.outputs.size(), 1);
+    QVERIFY(delta.outputs.value(2) & ConfigDiff::Field::Enabled);
+    QVERIFY(!delta.primary);
+
+    output(2)->set_enabled(true);
+    QVERIFY(ConfigDiff::compute(m_handler->config(), base).isEmpty());
+
+    output(1)->set_rotation(Disman::Output::Inverted);
+    output(1)->set_scale(2.);
+    delta = ConfigDiff::compute(m_handler->config(), ConfigDiff::Snapshot(base));
+    QCOMPARE(delta.outputs.value(1), ConfigDiff::Field::Rotation | ConfigDiff::Field::Scale);
+    QCOMPARE(delta.removedOutputs, 0);
+}
+
+QTEST_MAIN(TestConfigHandler)
+
+#include "testconfighandler.moc"
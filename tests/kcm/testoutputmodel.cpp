@@ -0,0 +1,183 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "../../kcm/config_handler.h"
+#include "../../kcm/output_model.h"
+
+#include "../../common/utils.h"
+
+#include <QObject>
+#include <QtTest>
+
+#include <disman/backendmanager_p.h>
+#include <disman/config.h>
+#include <disman/getconfigoperation.h>
+#include <disman/output.h>
+
+#include <memory>
+
+/**
+ * Tests what the output model reports to the view when outputs are rearranged. Three outputs are
+ * placed side by side in the order of their ids.
+ */
+class TestOutputModel : public QObject
+{
+    Q_OBJECT
+
+private:
+    OutputModel* model() const;
+    int row(int outputId) const;
+    QString name(int outputId) const;
+    QStringList replicationSources(int row) const;
+
+    std::unique_ptr<ConfigHandler> m_handler;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    void replicationSourcesAfterReorder();
+    void snapCandidatesAtMargin();
+};
+
+OutputModel* TestOutputModel::model() const
+{
+    return m_handler->outputModel();
+}
+
+int TestOutputModel::row(int outputId) const
+{
+    return model()->row(outputId);
+}
+
+QString TestOutputModel::name(int outputId) const
+{
+    return Utils::outputName(m_handler->config()->outputs().at(outputId));
+}
+
+QStringList TestOutputModel::replicationSources(int row) const
+{
+    return model()
+        ->data(model()->index(row), OutputModel::ReplicationSourceModelRole)
+        .toStringList();
+}
+
+void TestOutputModel::initTestCase()
+{
+    qputenv("DISMAN_IN_PROCESS", "1");
+    qputenv("DISMAN_LOGGING", "false");
+    qputenv("DISMAN_BACKEND_ARGS",
+            "TEST_DATA=" TEST_DATA "configs/laptopLidOpenAndTwoExternal.json");
+    setenv("DISMAN_BACKEND", "fake", 1);
+}
+
+void TestOutputModel::cleanupTestCase()
+{
+    Disman::BackendManager::instance()->shutdown_backend();
+}
+
+void TestOutputModel::init()
+{
+    auto op = new Disman::GetConfigOperation;
+    QVERIFY(op->exec());
+
+    auto const config = op->config();
+    for (auto const& [id, output] : config->outputs()) {
+        output->set_enabled(true);
+        output->set_resolution(QSize(1024, 768));
+        output->set_position(QPointF((id - 1) * 2000, 0));
+    }
+
+    m_handler = std::make_unique<ConfigHandler>();
+    m_handler->setConfig(config);
+    QCOMPARE(model()->rowCount(), 3);
+    QCOMPARE(row(1), 0);
+    QCOMPARE(row(2), 1);
+    QCOMPARE(row(3), 2);
+}
+
+void TestOutputModel::cleanup()
+{
+    m_handler.reset();
+}
+
+void TestOutputModel::replicationSourcesAfterReorder()
+{
+    // Output 3 replicates output 1, the first entry after "None" in its list.
+    QCOMPARE(replicationSources(row(3)).value(1), name(1));
+    QVERIFY(model()->setData(model()->index(row(3)), 1, OutputModel::ReplicationSourceIndexRole));
+
+    QHash<int, QStringList> sourcesBefore;
+    for (int id = 1; id <= 3; id++) {
+        sourcesBefore.insert(id, replicationSources(row(id)));
+    }
+
+    // Output 2 is moved in front of output 1.
+    QSignalSpy spy(model(), &QAbstractItemModel::dataChanged);
+    QVERIFY(model()->setData(
+        model()->index(row(2)), QPoint(-4000, 0), OutputModel::PositionRole));
+    QVERIFY(row(2) < row(1));
+
+    auto const notified = [&spy](int row) {
+        for (auto const& args : spy) {
+            auto const topLeft = args.at(0).toModelIndex();
+            auto const bottomRight = args.at(1).toModelIndex();
+            auto const roles = args.at(2).value<QList<int>>();
+            if (topLeft.row() <= row && row <= bottomRight.row()
+                && (roles.isEmpty() || roles.contains(OutputModel::ReplicationSourceModelRole))) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (int id = 1; id <= 3; id++) {
+        if (replicationSources(row(id)) != sourcesBefore.value(id)) {
+            QVERIFY2(notified(row(id)), qPrintable(QStringLiteral("output %1").arg(id)));
+        }
+    }
+
+    // The list shown for the replica and the index into it still name its source.
+    auto const replica = model()->index(row(3));
+    auto const sources = replicationSources(replica.row());
+    auto const index = model()->data(replica, OutputModel::ReplicationSourceIndexRole).toInt();
+    QCOMPARE(sources, QStringList({sources.first(), name(2), name(1)}));
+    QCOMPARE(sources.value(index), name(1));
+}
+
+void TestOutputModel::snapCandidatesAtMargin()
+{
+    auto const& targets = model()->m_snapTargets;
+    auto const target = std::find_if(targets.cbegin(), targets.cend(), [this](auto const& t) {
+        return t.rect.height() == model()->m_snapTargetsMaxHeight;
+    });
+    QVERIFY(target != targets.cend());
+
+    auto const contains = [](auto const& candidates, int id) {
+        return std::any_of(candidates.cbegin(), candidates.cend(), [id](auto const& candidate) {
+            return candidate.id == id;
+        });
+    };
+
+    // The highest target ends exactly at the snap distance above the rect.
+    auto rect = QRectF(target->rect.left(), target->rect.bottom() + 80, 100, 100);
+    QVERIFY(contains(model()->snapCandidates(rect), target->id));
+
+    rect.translate(0, 1);
+    QVERIFY(!contains(model()->snapCandidates(rect), target->id));
+
+    // The target starts exactly at the snap distance below the rect.
+    rect.moveBottom(target->rect.top() - 80);
+    QVERIFY(contains(model()->snapCandidates(rect), target->id));
+
+    rect.translate(0, -1);
+    QVERIFY(!contains(model()->snapCandidates(rect), target->id));
+}
+
+QTEST_MAIN(TestOutputModel)
+
+#include "testoutputmodel.moc"
@@ -0,0 +1,177 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "../../common/x_resources.h"
+
+#include <QFile>
+#include <QObject>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QtTest>
+
+#include <xcb/xcb.h>
+
+/**
+ * Tests updating the X resources. Writing to an X server runs against an Xvfb started by the
+ * test and is skipped if Xvfb is not installed.
+ */
+class TestXResources : public QObject
+{
+    Q_OBJECT
+
+private:
+    bool startXvfb();
+    void seedDatabase(const QByteArray& database);
+
+    QProcess m_xvfb;
+    QByteArray m_display;
+
+private Q_SLOTS:
+    void cleanupTestCase();
+
+    void setResource_data();
+    void setResource();
+    void noServer();
+    void writeXftDpi();
+};
+
+bool TestXResources::startXvfb()
+{
+    auto const xvfb = QStandardPaths::findExecutable(QStringLiteral("Xvfb"));
+    if (xvfb.isEmpty()) {
+        return false;
+    }
+
+    int number = 90;
+    while (QFile::exists(QStringLiteral("/tmp/.X%1-lock").arg(number))) {
+        number++;
+    }
+    m_display = ':' + QByteArray::number(number);
+
+    m_xvfb.start(xvfb,
+                 {QString::fromLatin1(m_display),
+                  QStringLiteral("-nolisten"),
+                  QStringLiteral("tcp"),
+                  QStringLiteral("-screen"),
+                  QStringLiteral("0"),
+                  QStringLiteral("640x480x24")});
+    if (!m_xvfb.waitForStarted()) {
+        return false;
+    }
+
+    // Wait until the server accepts connections.
+    for (int i = 0; i < 50; i++) {
+        auto const connection = xcb_connect(m_display.constData(), nullptr);
+        auto const error = xcb_connection_has_error(connection);
+        xcb_disconnect(connection);
+        if (!error) {
+            return true;
+        }
+        QTest::qWait(100);
+    }
+    return false;
+}
+
+void TestXResources::seedDatabase(const QByteArray& database)
+{
+    auto const connection = xcb_connect(m_display.constData(), nullptr);
+    QVERIFY(!xcb_connection_has_error(connection));
+
+    auto const root = xcb_setup_roots_iterator(xcb_get_setup(connection)).data->root;
+    xcb_change_property(connection,
+                        XCB_PROP_MODE_REPLACE,
+                        root,
+                        XCB_ATOM_RESOURCE_MANAGER,
+                        XCB_ATOM_STRING,
+                        8,
+                        database.size(),
+                        database.constData());
+    free(xcb_get_input_focus_reply(connection, xcb_get_input_focus(connection), nullptr));
+    xcb_disconnect(connection);
+}
+
+void TestXResources::cleanupTestCase()
+{
+    if (m_xvfb.state() != QProcess::NotRunning) {
+        m_xvfb.terminate();
+        m_xvfb.waitForFinished();
+    }
+}
+
+void TestXResources::setResource_data()
+{
+    QTest::addColumn<QByteArray>("database");
+    QTest::addColumn<QByteArray>("value");
+    QTest::addColumn<QByteArray>("expected");
+
+    QTest::addRow("add to empty") << QByteArray() << QByteArray("96")
+                                  << QByteArray("Xft.dpi:\t96\n");
+    QTest::addRow("add") << QByteArray("Xft.hinting:\t1\n") << QByteArray("96")
+                         << QByteArray("Xft.hinting:\t1\nXft.dpi:\t96\n");
+    QTest::addRow("replace in place")
+        << QByteArray("Xft.dpi:\t120\nXft.hinting:\t1\n") << QByteArray("96")
+        << QByteArray("Xft.dpi:\t96\nXft.hinting:\t1\n");
+    QTest::addRow("replace with spaces") << QByteArray("Xft.dpi :  120\n") << QByteArray("96")
+                                         << QByteArray("Xft.dpi:\t96\n");
+    QTest::addRow("drop duplicates")
+        << QByteArray("Xft.dpi:\t120\nXft.hinting:\t1\nXft.dpi:\t144\n") << QByteArray("96")
+        << QByteArray("Xft.dpi:\t96\nXft.hinting:\t1\n");
+    QTest::addRow("remove") << QByteArray("Xft.hinting:\t1\nXft.dpi:\t120\nXft.rgba:\trgb\n")
+                            << QByteArray() << QByteArray("Xft.hinting:\t1\nXft.rgba:\trgb\n");
+    QTest::addRow("keep similar names")
+        << QByteArray("Xft.dpis:\t1\n*Xft.dpi:\t120\n") << QByteArray()
+        << QByteArray("Xft.dpis:\t1\n*Xft.dpi:\t120\n");
+    QTest::addRow("missing final newline") << QByteArray("Xft.hinting:\t1") << QByteArray("96")
+                                           << QByteArray("Xft.hinting:\t1\nXft.dpi:\t96\n");
+    QTest::addRow("keep blank lines")
+        << QByteArray("Xft.hinting:\t1\n\nXft.dpi:\t120\n\n") << QByteArray("96")
+        << QByteArray("Xft.hinting:\t1\n\nXft.dpi:\t96\n\n");
+    QTest::addRow("remove keeps blank lines")
+        << QByteArray("\nXft.dpi:\t120\n\nXft.rgba:\trgb\n") << QByteArray()
+        << QByteArray("\n\nXft.rgba:\trgb\n");
+    QTest::addRow("unchanged") << QByteArray("Xft.hinting:\t1\n\nXft.dpi:\t96\n")
+                               << QByteArray("96")
+                               << QByteArray("Xft.hinting:\t1\n\nXft.dpi:\t96\n");
+    QTest::addRow("unchanged with spaces")
+        << QByteArray("Xft.dpi : 96\n") << QByteArray("96") << QByteArray("Xft.dpi : 96\n");
+}
+
+void TestXResources::setResource()
+{
+    QFETCH(QByteArray, database);
+    QFETCH(QByteArray, value);
+    QFETCH(QByteArray, expected);
+
+    QCOMPARE(XResources::setResource(database, QByteArrayLiteral("Xft.dpi"), value), expected);
+}
+
+void TestXResources::noServer()
+{
+    QVERIFY(!XResources::writeXftDpi(96, QByteArrayLiteral(":65000")));
+    QVERIFY(XResources::database(QByteArrayLiteral(":65000")).isEmpty());
+}
+
+void TestXResources::writeXftDpi()
+{
+    if (!startXvfb()) {
+        QSKIP("Xvfb is not available.");
+    }
+
+    seedDatabase(QByteArrayLiteral("Xft.antialias:\t1\nXft.dpi:\t96\n"));
+
+    QVERIFY(XResources::writeXftDpi(144, m_display));
+    QCOMPARE(XResources::database(m_display), QByteArray("Xft.antialias:\t1\nXft.dpi:\t144\n"));
+
+    // Writing the same value again leaves the database untouched.
+    QVERIFY(XResources::writeXftDpi(144, m_display));
+    QCOMPARE(XResources::database(m_display), QByteArray("Xft.antialias:\t1\nXft.dpi:\t144\n"));
+
+    QVERIFY(XResources::writeXftDpi(0, m_display));
+    QCOMPARE(XResources::database(m_display), QByteArray("Xft.antialias:\t1\n"));
+}
+
+QTEST_GUILESS_MAIN(TestXResources)
+
+#include "testxresources.moc"
@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "../../plasma-integration/kded/daemon.h"
+
+#include <QObject>
+#include <QtTest>
+
+#include <disman/backendmanager_p.h>
+#include <disman/config.h>
+#include <disman/output.h>
+
+#include <memory>
+
+/**
+ * Tests how the daemon applies configs while earlier ones are still being applied. Orientation
+ * changes are handed to the daemon directly since there is no sensor in the test.
+ */
+class TestDaemon : public QObject
+{
+    Q_OBJECT
+
+private:
+    Disman::OutputPtr panel() const;
+
+    std::unique_ptr<KDisplayDaemon> m_daemon;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+
+    void rotateBackWhileApplying();
+};
+
+Disman::OutputPtr TestDaemon::panel() const
+{
+    for (auto const& [key, output] : m_daemon->m_monitoredConfig->outputs()) {
+        if (output->type() == Disman::Output::Type::Panel) {
+            return output;
+        }
+    }
+    return nullptr;
+}
+
+void TestDaemon::initTestCase()
+{
+    qputenv("DISMAN_IN_PROCESS", "1");
+    qputenv("DISMAN_LOGGING", "false");
+    qputenv("DISMAN_BACKEND", "fake");
+    qputenv("DISMAN_BACKEND_ARGS", "TEST_DATA=" TEST_DATA "configs/laptopAndExternal.json");
+}
+
+void TestDaemon::cleanupTestCase()
+{
+    Disman::BackendManager::instance()->shutdown_backend();
+}
+
+void TestDaemon::init()
+{
+    m_daemon = std::make_unique<KDisplayDaemon>(nullptr, QList<QVariant>());
+    QTRY_VERIFY(m_daemon->m_monitoredConfig);
+    QVERIFY(m_daemon->m_monitoring);
+
+    auto const output = panel();
+    QVERIFY(output);
+    output->set_auto_rotate(true);
+    output->set_auto_rotate_only_in_tablet_mode(false);
+}
+
+void TestDaemon::cleanup()
+{
+    m_daemon.reset();
+    Disman::BackendManager::instance()->shutdown_backend();
+}
+
+void TestDaemon::rotateBackWhileApplying()
+{
+    m_daemon->applyOrientation(QOrientationReading::LeftUp);
+    QVERIFY(!m_daemon->m_monitoring);
+
+    // The apply has not finished yet. The device is rotated away and back again, so once it
+    // finishes the config is the one that was applied and there is nothing more to apply.
+    m_daemon->applyOrientation(QOrientationReading::TopUp);
+    m_daemon->applyOrientation(QOrientationReading::LeftUp);
+    QVERIFY(m_daemon->m_configDirty);
+
+    QTRY_VERIFY(m_daemon->m_monitoring);
+    QVERIFY(!m_daemon->m_configDirty);
+    QCOMPARE(panel()->rotation(), Disman::Output::Rotation::Right);
+
+    // Later changes are still applied.
+    m_daemon->applyOrientation(QOrientationReading::TopUp);
+    QVERIFY(!m_daemon->m_monitoring);
+    QTRY_VERIFY(m_daemon->m_monitoring);
+    QCOMPARE(panel()->rotation(), Disman::Output::Rotation::None);
+}
+
+QTEST_MAIN(TestDaemon)
+
+#include "testdaemon.moc"